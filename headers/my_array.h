@@ -3,6 +3,8 @@
 
 #include <iostream>
 
+#include "my_checks.h"
+
 namespace my {
 template <typename T, std::size_t N>
 class array {
@@ -86,13 +88,15 @@ inline typename array<T, N>::array &array<T, N>::operator=(array &&a) noexcept {
 
 template <typename T, std::size_t N>
 inline typename array<T, N>::reference array<T, N>::operator[](size_type pos) {
-  return at(pos);
+  MY_CONTAINERS_ASSERT(pos < N, "array index out of range");
+  return arr[pos];
 }
 
 template <typename T, std::size_t N>
 inline typename array<T, N>::const_reference array<T, N>::operator[](
     size_type pos) const {
-  return at(pos);
+  MY_CONTAINERS_ASSERT(pos < N, "array index out of range");
+  return arr[pos];
 }
 
 template <typename T, std::size_t N>
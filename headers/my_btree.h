@@ -0,0 +1,1009 @@
+#ifndef _MY_CONTAINER_BTREE_H
+#define _MY_CONTAINER_BTREE_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "my_node_pool.h"
+#include "my_vector.h"
+
+namespace my {
+
+// A B-tree that keeps up to max_values elements next to each other in
+// every node, so a lookup reads a few cache lines per level instead of one
+// scattered node per comparison, and a node costs two words of overhead
+// per max_values elements instead of three pointers per element. NodeBytes
+// is the size a node's elements are fitted into; the default of 256 is
+// four cache lines.
+//
+// Elements move between nodes as the tree changes shape, so unlike
+// rb_tree any insert or erase invalidates every iterator.
+template <typename T, typename Compare = std::less<T>,
+          size_t NodeBytes = 256>
+class btree {
+ public:
+  class iterator;
+  class const_iterator;
+
+  using value_type = T;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = size_t;
+  using value_compare = Compare;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+
+  // At least three elements a node, so that a split leaves both halves
+  // non-empty.
+  static constexpr size_type max_values =
+      std::max<size_type>(3, NodeBytes / sizeof(T));
+  static constexpr size_type min_values = (max_values - 1) / 2;
+  static_assert(max_values <= std::numeric_limits<unsigned short>::max(),
+                "NodeBytes is too large for the element type");
+
+  btree();
+  explicit btree(const Compare &comp);
+  btree(const btree &other);
+  btree(btree &&other) noexcept;
+  ~btree();
+  btree &operator=(btree &&other) noexcept;
+
+  iterator begin();
+  iterator end();
+  reverse_iterator rbegin();
+  reverse_iterator rend();
+
+  bool empty();
+  size_type size();
+  size_type max_size();
+  value_compare value_comp() const;
+
+  void clear();
+  std::pair<iterator, bool> insert(value_type key);
+  // key goes right before hint when it belongs there, which spares the
+  // descent from the root, e.g. with end() while keys come in ascending
+  // order.
+  iterator insert(iterator hint, value_type key);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args);
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args);
+  void erase(iterator pos);
+  void swap(btree &other);
+
+  // Moves over the elements of other that this tree lacks and leaves the
+  // rest in other.
+  void merge(btree &other);
+
+  // Replaces the contents with [first, last), filling the nodes one after
+  // the other when the range is already sorted; any other range is sorted
+  // first. Of equivalent elements the first one is kept.
+  template <typename InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
+  iterator find(const_reference key);
+  bool contains(const_reference key);
+
+  // Lookups by any type the comparator orders against value_type, enabled
+  // for transparent comparators such as std::less<>.
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key);
+
+  // Half-open bounds by one descent from the root.
+  iterator lower_bound(const_reference key);
+  iterator upper_bound(const_reference key);
+  std::pair<iterator, iterator> equal_range(const_reference key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key);
+
+ protected:
+  struct node;
+
+ public:
+  // A node and a slot in it. end() is the slot past the last element of
+  // the rightmost leaf, so that it can be decremented.
+  class iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    iterator() = default;
+    iterator(node *nd, size_type pos);
+    reference operator*() const;
+    pointer operator->() const;
+    bool operator==(const iterator &other) const;
+    bool operator!=(const iterator &other) const;
+    iterator &operator++();
+    iterator operator++(int);
+    iterator &operator--();
+    iterator operator--(int);
+
+   protected:
+    friend class btree;
+
+    node *nd_ = nullptr;
+    size_type pos_ = 0;
+  };
+
+  class const_iterator : public iterator {
+   public:
+    const_reference operator*() const;
+  };
+
+ protected:
+  // The first count slots of values hold elements. Leaves are allocated
+  // as plain nodes; only inner nodes carry the children array.
+  struct node {
+    node *parent = nullptr;
+    unsigned short position = 0;
+    unsigned short count = 0;
+    bool leaf = true;
+    union {
+      value_type values[max_values];
+    };
+
+    node() {}
+    ~node() {}
+  };
+
+  struct inner_node : node {
+    node *children[max_values + 1];
+
+    inner_node() { this->leaf = false; }
+  };
+
+  // Where a key goes: before slot pos of the leaf nd, unless found says
+  // that slot of nd holds an equivalent element already.
+  struct insert_position {
+    node *nd;
+    size_type pos;
+    bool found;
+  };
+
+  template <typename K>
+  size_type lower_index(const node *nd, const K &key) const;
+  template <typename K>
+  iterator find_iter(const K &key);
+  template <typename K>
+  iterator lower_bound_iter(const K &key);
+  template <typename K>
+  iterator upper_bound_iter(const K &key);
+  template <typename K>
+  std::pair<iterator, iterator> equal_range_iter(const K &key);
+  template <typename K>
+  insert_position find_insert_pos(const K &key);
+  template <typename K>
+  insert_position find_hint_pos(iterator hint, const K &key);
+  template <typename... Args>
+  iterator insert_at(insert_position pos, Args &&...args);
+  iterator insert_into_leaf(node *nd, size_type pos, value_type &&value);
+  size_type split(node *nd, size_type insert_pos);
+  void rebalance(node *nd);
+  void rotate_left(node *parent, size_type i);
+  void rotate_right(node *parent, size_type i);
+  void merge_children(node *parent, size_type i);
+  static void insert_value(node *nd, size_type pos, value_type &&value);
+  static void remove_value(node *nd, size_type pos);
+  static void move_values(node *from, size_type first, size_type n, node *to,
+                          size_type dest);
+  static node *child(const node *nd, size_type i);
+  static void set_child(node *nd, size_type i, node *c);
+  static node *leftmost_leaf(node *nd);
+  static node *rightmost_leaf(node *nd);
+  template <typename It>
+  void assign_unique_sorted(It first, size_type n);
+  void assign_buffer(Vector<value_type> &buf, bool keep_last);
+  node *create_node(bool leaf);
+  void destroy_node(node *nd);
+  node *copy(const node *nd);
+  void free_tree();
+  void free_subtree(node *nd);
+  void update_extremes();
+
+  node *root = nullptr;
+  node *leftmost_ = nullptr;
+  node *rightmost_ = nullptr;
+  size_type count_ = 0;
+  node_pool<node> leaves_;
+  node_pool<inner_node> inners_;
+  Compare comp_;
+};
+
+template <typename T, typename Compare, size_t NodeBytes>
+btree<T, Compare, NodeBytes>::btree() {}
+
+template <typename T, typename Compare, size_t NodeBytes>
+btree<T, Compare, NodeBytes>::btree(const Compare &comp) : comp_(comp) {}
+
+template <typename T, typename Compare, size_t NodeBytes>
+btree<T, Compare, NodeBytes>::btree(const btree &other)
+    : count_(other.count_), comp_(other.comp_) {
+  if (other.root) root = copy(other.root);
+  update_extremes();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+btree<T, Compare, NodeBytes>::btree(btree &&other) noexcept
+    : root(other.root),
+      leftmost_(other.leftmost_),
+      rightmost_(other.rightmost_),
+      count_(other.count_),
+      leaves_(std::move(other.leaves_)),
+      inners_(std::move(other.inners_)),
+      comp_(other.comp_) {
+  other.root = other.leftmost_ = other.rightmost_ = nullptr;
+  other.count_ = 0;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+btree<T, Compare, NodeBytes>::~btree() {
+  free_tree();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+btree<T, Compare, NodeBytes> &btree<T, Compare, NodeBytes>::operator=(
+    btree &&other) noexcept {
+  if (this != &other) {
+    clear();
+    swap(other);
+  }
+
+  return *this;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::begin() {
+  return iterator(leftmost_, 0);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::end() {
+  return iterator(rightmost_, rightmost_ ? rightmost_->count : 0);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::reverse_iterator
+btree<T, Compare, NodeBytes>::rbegin() {
+  return reverse_iterator(end());
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::reverse_iterator
+btree<T, Compare, NodeBytes>::rend() {
+  return reverse_iterator(begin());
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline bool btree<T, Compare, NodeBytes>::empty() {
+  return root == nullptr;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline size_t btree<T, Compare, NodeBytes>::size() {
+  return count_;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline size_t btree<T, Compare, NodeBytes>::max_size() {
+  return std::numeric_limits<size_type>::max() / sizeof(value_type);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline typename btree<T, Compare, NodeBytes>::value_compare
+btree<T, Compare, NodeBytes>::value_comp() const {
+  return comp_;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::clear() {
+  free_tree();
+  root = leftmost_ = rightmost_ = nullptr;
+  count_ = 0;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename std::pair<typename btree<T, Compare, NodeBytes>::iterator, bool>
+btree<T, Compare, NodeBytes>::insert(value_type key) {
+  insert_position pos = find_insert_pos(key);
+
+  if (pos.found)
+    return std::pair<iterator, bool>(iterator(pos.nd, pos.pos), false);
+  return std::pair<iterator, bool>(insert_at(pos, std::move(key)), true);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::insert(iterator hint, value_type key) {
+  insert_position pos = find_hint_pos(hint, key);
+
+  if (pos.found) return iterator(pos.nd, pos.pos);
+  return insert_at(pos, std::move(key));
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename... Args>
+typename std::pair<typename btree<T, Compare, NodeBytes>::iterator, bool>
+btree<T, Compare, NodeBytes>::emplace(Args &&...args) {
+  value_type key(std::forward<Args>(args)...);
+  return insert(std::move(key));
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename... Args>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::emplace_hint(iterator hint, Args &&...args) {
+  value_type key(std::forward<Args>(args)...);
+  return insert(hint, std::move(key));
+}
+
+// An element of an inner node trades places with its predecessor, which
+// sits at the end of a leaf, so elements are only ever taken out of
+// leaves.
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::erase(iterator pos) {
+  node *nd = pos.nd_;
+  size_type i = pos.pos_;
+  if (!nd || i >= nd->count) return;
+
+  if (!nd->leaf) {
+    node *leaf = rightmost_leaf(child(nd, i));
+    nd->values[i] = std::move(leaf->values[leaf->count - 1]);
+    nd = leaf;
+    i = leaf->count - 1;
+  }
+  remove_value(nd, i);
+  count_--;
+  rebalance(nd);
+  update_extremes();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline void btree<T, Compare, NodeBytes>::swap(btree &other) {
+  std::swap(root, other.root);
+  std::swap(leftmost_, other.leftmost_);
+  std::swap(rightmost_, other.rightmost_);
+  std::swap(count_, other.count_);
+  leaves_.swap(other.leaves_);
+  inners_.swap(other.inners_);
+  std::swap(comp_, other.comp_);
+}
+
+// Elements move rather than nodes, since nodes are shared by neighbours.
+// What this tree already has is gathered in order and rebuilt into other.
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::merge(btree &other) {
+  if (this == &other || other.root == nullptr) return;
+
+  Vector<value_type> rest;
+  for (iterator it = other.begin(); it != other.end(); ++it) {
+    insert_position pos = find_insert_pos(*it);
+    if (pos.found)
+      rest.push_back(std::move(*it));
+    else
+      insert_at(pos, std::move(*it));
+  }
+  other.assign_unique_sorted(std::make_move_iterator(rest.begin()),
+                             rest.size());
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename InputIt>
+void btree<T, Compare, NodeBytes>::assign_sorted(InputIt first,
+                                                 InputIt last) {
+  using category = typename std::iterator_traits<InputIt>::iterator_category;
+
+  if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+    auto out_of_order = [this](const_reference a, const_reference b) {
+      return !comp_(a, b);
+    };
+    if (std::adjacent_find(first, last, out_of_order) == last) {
+      assign_unique_sorted(first, std::distance(first, last));
+      return;
+    }
+  }
+  Vector<value_type> buf;
+  buf.insert(buf.end(), first, last);
+  assign_buffer(buf, false);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::find(const_reference key) {
+  return find_iter(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+bool btree<T, Compare, NodeBytes>::contains(const_reference key) {
+  return find_iter(key) != end();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::find(const K &key) {
+  return find_iter(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+bool btree<T, Compare, NodeBytes>::contains(const K &key) {
+  return find_iter(key) != end();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::lower_bound(const_reference key) {
+  return lower_bound_iter(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::upper_bound(const_reference key) {
+  return upper_bound_iter(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+std::pair<typename btree<T, Compare, NodeBytes>::iterator,
+          typename btree<T, Compare, NodeBytes>::iterator>
+btree<T, Compare, NodeBytes>::equal_range(const_reference key) {
+  return equal_range_iter(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::lower_bound(const K &key) {
+  return lower_bound_iter(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::upper_bound(const K &key) {
+  return upper_bound_iter(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+std::pair<typename btree<T, Compare, NodeBytes>::iterator,
+          typename btree<T, Compare, NodeBytes>::iterator>
+btree<T, Compare, NodeBytes>::equal_range(const K &key) {
+  return equal_range_iter(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+btree<T, Compare, NodeBytes>::iterator::iterator(node *nd, size_type pos)
+    : nd_(nd), pos_(pos) {}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator::reference
+btree<T, Compare, NodeBytes>::iterator::operator*() const {
+  return nd_->values[pos_];
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator::pointer
+btree<T, Compare, NodeBytes>::iterator::operator->() const {
+  return &nd_->values[pos_];
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline bool btree<T, Compare, NodeBytes>::iterator::operator==(
+    const iterator &other) const {
+  return nd_ == other.nd_ && pos_ == other.pos_;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline bool btree<T, Compare, NodeBytes>::iterator::operator!=(
+    const iterator &other) const {
+  return !(*this == other);
+}
+
+// Inside a leaf this is a step to the next slot. Past the end of a leaf
+// the next element is the separator above the first ancestor reached
+// from the left; if there is none, the iterator stays put as end().
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator &
+btree<T, Compare, NodeBytes>::iterator::operator++() {
+  if (!nd_->leaf) {
+    nd_ = leftmost_leaf(child(nd_, pos_ + 1));
+    pos_ = 0;
+    return *this;
+  }
+  if (++pos_ < nd_->count) return *this;
+
+  node *nd = nd_;
+  size_type pos = pos_;
+  while (pos == nd->count && nd->parent) {
+    pos = nd->position;
+    nd = nd->parent;
+  }
+  if (pos < nd->count) {
+    nd_ = nd;
+    pos_ = pos;
+  }
+  return *this;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::iterator::operator++(int) {
+  iterator tmp = *this;
+  ++*this;
+  return tmp;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator &
+btree<T, Compare, NodeBytes>::iterator::operator--() {
+  if (!nd_->leaf) {
+    nd_ = rightmost_leaf(child(nd_, pos_));
+    pos_ = nd_->count - 1;
+    return *this;
+  }
+  while (pos_ == 0 && nd_->parent) {
+    pos_ = nd_->position;
+    nd_ = nd_->parent;
+  }
+  pos_--;
+  return *this;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::iterator::operator--(int) {
+  iterator tmp = *this;
+  --*this;
+  return tmp;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::const_reference
+btree<T, Compare, NodeBytes>::const_iterator::operator*() const {
+  return iterator::operator*();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K>
+inline typename btree<T, Compare, NodeBytes>::size_type
+btree<T, Compare, NodeBytes>::lower_index(const node *nd,
+                                          const K &key) const {
+  return std::lower_bound(nd->values, nd->values + nd->count, key, comp_) -
+         nd->values;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::find_iter(const K &key) {
+  node *nd = root;
+  while (nd) {
+    size_type i = lower_index(nd, key);
+    if (i < nd->count && !comp_(key, nd->values[i])) return iterator(nd, i);
+    nd = nd->leaf ? nullptr : child(nd, i);
+  }
+  return end();
+}
+
+// The lowest slot left of the descent path at or above key is the bound;
+// an equivalent key ends the descent early since keys are unique.
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::lower_bound_iter(const K &key) {
+  iterator res = end();
+  node *nd = root;
+  while (nd) {
+    size_type i = lower_index(nd, key);
+    if (i < nd->count) {
+      res = iterator(nd, i);
+      if (!comp_(key, nd->values[i])) break;
+    }
+    nd = nd->leaf ? nullptr : child(nd, i);
+  }
+  return res;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::upper_bound_iter(const K &key) {
+  iterator res = end();
+  node *nd = root;
+  while (nd) {
+    size_type i =
+        std::upper_bound(nd->values, nd->values + nd->count, key, comp_) -
+        nd->values;
+    if (i < nd->count) res = iterator(nd, i);
+    nd = nd->leaf ? nullptr : child(nd, i);
+  }
+  return res;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K>
+std::pair<typename btree<T, Compare, NodeBytes>::iterator,
+          typename btree<T, Compare, NodeBytes>::iterator>
+btree<T, Compare, NodeBytes>::equal_range_iter(const K &key) {
+  iterator lo = lower_bound_iter(key);
+  if (lo == end() || comp_(key, *lo)) return {lo, lo};
+  iterator hi = lo;
+  return {lo, ++hi};
+}
+
+// Keys past the current maximum go straight to the end of the rightmost
+// leaf, which makes ascending inserts O(1) amortised.
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K>
+typename btree<T, Compare, NodeBytes>::insert_position
+btree<T, Compare, NodeBytes>::find_insert_pos(const K &key) {
+  if (root == nullptr) return {nullptr, 0, false};
+  if (comp_(rightmost_->values[rightmost_->count - 1], key))
+    return {rightmost_, rightmost_->count, false};
+
+  node *nd = root;
+  while (true) {
+    size_type i = lower_index(nd, key);
+    if (i < nd->count && !comp_(key, nd->values[i])) return {nd, i, true};
+    if (nd->leaf) return {nd, i, false};
+    nd = child(nd, i);
+  }
+}
+
+// The gap right before hint is the slot hint names in a leaf, or the end
+// of the rightmost leaf under it in an inner node.
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename K>
+typename btree<T, Compare, NodeBytes>::insert_position
+btree<T, Compare, NodeBytes>::find_hint_pos(iterator hint, const K &key) {
+  if (root == nullptr) return {nullptr, 0, false};
+
+  if (hint == end() || comp_(key, *hint)) {
+    iterator prev = hint;
+    if (hint == begin() || comp_(*--prev, key)) {
+      if (hint.nd_->leaf) return {hint.nd_, hint.pos_, false};
+      node *leaf = rightmost_leaf(child(hint.nd_, hint.pos_));
+      return {leaf, leaf->count, false};
+    }
+  }
+  return find_insert_pos(key);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename... Args>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::insert_at(insert_position pos,
+                                        Args &&...args) {
+  value_type value(std::forward<Args>(args)...);
+  if (pos.nd == nullptr) {
+    root = create_node(true);
+    update_extremes();
+    pos.nd = root;
+  }
+  return insert_into_leaf(pos.nd, pos.pos, std::move(value));
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::iterator
+btree<T, Compare, NodeBytes>::insert_into_leaf(node *nd, size_type pos,
+                                               value_type &&value) {
+  if (nd->count == max_values) {
+    size_type mid = split(nd, pos);
+    if (pos > mid) {
+      nd = child(nd->parent, nd->position + 1);
+      pos -= mid + 1;
+    }
+    update_extremes();
+  }
+  insert_value(nd, pos, std::move(value));
+  count_++;
+  return iterator(nd, pos);
+}
+
+// Moves the elements after slot mid of a full node into a new right
+// sibling and the one at mid up into the parent, splitting a full parent
+// first. Returns mid. A node filled at its end keeps all but one element,
+// so that ascending inserts leave full nodes behind instead of half empty
+// ones; the sibling is then left under min_values, which erase copes
+// with.
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::size_type
+btree<T, Compare, NodeBytes>::split(node *nd, size_type insert_pos) {
+  node *parent = nd->parent;
+  if (parent == nullptr) {
+    parent = create_node(false);
+    set_child(parent, 0, nd);
+    root = parent;
+  } else if (parent->count == max_values) {
+    split(parent, nd->position);
+    parent = nd->parent;
+  }
+
+  size_type mid = insert_pos == max_values ? max_values - 1 : max_values / 2;
+  node *sibling = create_node(nd->leaf);
+  size_type moved = nd->count - mid - 1;
+  move_values(nd, mid + 1, moved, sibling, 0);
+  if (!nd->leaf) {
+    for (size_type i = 0; i <= moved; i++)
+      set_child(sibling, i, child(nd, mid + 1 + i));
+  }
+  sibling->count = moved;
+
+  value_type median(std::move(nd->values[mid]));
+  nd->values[mid].~value_type();
+  nd->count = mid;
+
+  size_type at = nd->position;
+  for (size_type i = parent->count; i > at; i--)
+    set_child(parent, i + 1, child(parent, i));
+  set_child(parent, at + 1, sibling);
+  insert_value(parent, at, std::move(median));
+  return mid;
+}
+
+// Refills a node that fell under min_values from a sibling that can spare
+// an element, or else merges it with a sibling and carries on with the
+// parent, which lost a separator. A root left without elements gives way
+// to its only child.
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::rebalance(node *nd) {
+  while (nd != root && nd->count < min_values) {
+    node *parent = nd->parent;
+    size_type i = nd->position;
+    node *left = i > 0 ? child(parent, i - 1) : nullptr;
+    node *right = i < parent->count ? child(parent, i + 1) : nullptr;
+
+    if (left && left->count > min_values) {
+      rotate_right(parent, i - 1);
+      return;
+    }
+    if (right && right->count > min_values) {
+      rotate_left(parent, i);
+      return;
+    }
+    merge_children(parent, left ? i - 1 : i);
+    nd = parent;
+  }
+
+  if (root->count == 0) {
+    node *old = root;
+    root = old->leaf ? nullptr : child(old, 0);
+    if (root) root->parent = nullptr;
+    destroy_node(old);
+  }
+}
+
+// Moves the first element of child i + 1 up into the separator and the
+// separator down to the end of child i.
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::rotate_left(node *parent, size_type i) {
+  node *left = child(parent, i);
+  node *right = child(parent, i + 1);
+
+  insert_value(left, left->count, std::move(parent->values[i]));
+  if (!left->leaf) set_child(left, left->count, child(right, 0));
+  parent->values[i] = std::move(right->values[0]);
+  remove_value(right, 0);
+  if (!right->leaf) {
+    for (size_type j = 0; j <= right->count; j++)
+      set_child(right, j, child(right, j + 1));
+  }
+}
+
+// The mirror image of rotate_left().
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::rotate_right(node *parent, size_type i) {
+  node *left = child(parent, i);
+  node *right = child(parent, i + 1);
+
+  if (!right->leaf) {
+    for (size_type j = right->count + 1; j > 0; j--)
+      set_child(right, j, child(right, j - 1));
+    set_child(right, 0, child(left, left->count));
+  }
+  insert_value(right, 0, std::move(parent->values[i]));
+  parent->values[i] = std::move(left->values[left->count - 1]);
+  remove_value(left, left->count - 1);
+}
+
+// Appends separator i and all of child i + 1 to child i, then drops the
+// emptied node.
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::merge_children(node *parent,
+                                                  size_type i) {
+  node *left = child(parent, i);
+  node *right = child(parent, i + 1);
+  size_type base = left->count + 1;
+
+  insert_value(left, left->count, std::move(parent->values[i]));
+  move_values(right, 0, right->count, left, base);
+  if (!left->leaf) {
+    for (size_type j = 0; j <= right->count; j++)
+      set_child(left, base + j, child(right, j));
+  }
+  left->count += right->count;
+  right->count = 0;
+
+  remove_value(parent, i);
+  for (size_type j = i + 1; j <= parent->count; j++)
+    set_child(parent, j, child(parent, j + 1));
+  destroy_node(right);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::insert_value(node *nd, size_type pos,
+                                                value_type &&value) {
+  value_type *values = nd->values;
+  if (pos == nd->count) {
+    new (values + pos) value_type(std::move(value));
+  } else {
+    new (values + nd->count) value_type(std::move(values[nd->count - 1]));
+    std::move_backward(values + pos, values + nd->count - 1,
+                       values + nd->count);
+    values[pos] = std::move(value);
+  }
+  nd->count++;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::remove_value(node *nd, size_type pos) {
+  value_type *values = nd->values;
+  std::move(values + pos + 1, values + nd->count, values + pos);
+  values[nd->count - 1].~value_type();
+  nd->count--;
+}
+
+// Move-constructs n elements into raw slots of to and destroys their
+// sources; counts are left to the caller.
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::move_values(node *from, size_type first,
+                                               size_type n, node *to,
+                                               size_type dest) {
+  for (size_type i = 0; i < n; i++) {
+    new (to->values + dest + i) value_type(std::move(from->values[first + i]));
+    from->values[first + i].~value_type();
+  }
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline typename btree<T, Compare, NodeBytes>::node *
+btree<T, Compare, NodeBytes>::child(const node *nd, size_type i) {
+  return static_cast<const inner_node *>(nd)->children[i];
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+inline void btree<T, Compare, NodeBytes>::set_child(node *nd, size_type i,
+                                                    node *c) {
+  static_cast<inner_node *>(nd)->children[i] = c;
+  c->parent = nd;
+  c->position = i;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::node *
+btree<T, Compare, NodeBytes>::leftmost_leaf(node *nd) {
+  while (!nd->leaf) nd = child(nd, 0);
+  return nd;
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::node *
+btree<T, Compare, NodeBytes>::rightmost_leaf(node *nd) {
+  while (!nd->leaf) nd = child(nd, nd->count);
+  return nd;
+}
+
+// Replaces the contents with n sorted, unique elements, each appended to
+// the rightmost leaf.
+template <typename T, typename Compare, size_t NodeBytes>
+template <typename It>
+void btree<T, Compare, NodeBytes>::assign_unique_sorted(It first,
+                                                        size_type n) {
+  clear();
+  for (size_type i = 0; i < n; i++, ++first) {
+    if (root == nullptr)
+      insert_at({nullptr, 0, false}, *first);
+    else
+      insert_at({rightmost_, rightmost_->count, false}, *first);
+  }
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::assign_buffer(Vector<value_type> &buf,
+                                                 bool keep_last) {
+  if (!std::is_sorted(buf.begin(), buf.end(), comp_))
+    std::stable_sort(buf.begin(), buf.end(), comp_);
+
+  size_type n = 0;
+  for (size_type i = 0; i < buf.size(); i++) {
+    if (n > 0 && !comp_(buf[n - 1], buf[i])) {
+      if (keep_last) buf[n - 1] = std::move(buf[i]);
+    } else {
+      if (n != i) buf[n] = std::move(buf[i]);
+      n++;
+    }
+  }
+  assign_unique_sorted(std::make_move_iterator(buf.begin()), n);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::node *
+btree<T, Compare, NodeBytes>::create_node(bool leaf) {
+  if (leaf) return new (leaves_.allocate()) node();
+  return new (inners_.allocate()) inner_node();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::destroy_node(node *nd) {
+  for (size_type i = 0; i < nd->count; i++) nd->values[i].~value_type();
+  if (nd->leaf) {
+    nd->~node();
+    leaves_.deallocate(nd);
+  } else {
+    inner_node *in = static_cast<inner_node *>(nd);
+    in->~inner_node();
+    inners_.deallocate(in);
+  }
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename btree<T, Compare, NodeBytes>::node *
+btree<T, Compare, NodeBytes>::copy(const node *nd) {
+  node *res = create_node(nd->leaf);
+  for (; res->count < nd->count; res->count++)
+    new (res->values + res->count) value_type(nd->values[res->count]);
+  if (!nd->leaf) {
+    for (size_type i = 0; i <= nd->count; i++)
+      set_child(res, i, copy(child(nd, i)));
+  }
+  return res;
+}
+
+// The pools hand back all nodes at once; elements only need visiting when
+// they have a destructor to run.
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::free_tree() {
+  if constexpr (!std::is_trivially_destructible_v<value_type>) {
+    if (root) free_subtree(root);
+  }
+  leaves_.release();
+  inners_.release();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::free_subtree(node *nd) {
+  if (!nd->leaf) {
+    for (size_type i = 0; i <= nd->count; i++) free_subtree(child(nd, i));
+  }
+  for (size_type i = 0; i < nd->count; i++) nd->values[i].~value_type();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+void btree<T, Compare, NodeBytes>::update_extremes() {
+  leftmost_ = root ? leftmost_leaf(root) : nullptr;
+  rightmost_ = root ? rightmost_leaf(root) : nullptr;
+}
+
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_BTREE_H
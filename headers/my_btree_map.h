@@ -0,0 +1,312 @@
+#ifndef _MY_CONTAINER_BTREE_MAP_H
+#define _MY_CONTAINER_BTREE_MAP_H
+
+#include <tuple>
+
+#include "my_btree.h"
+#include "my_rbtree.h"
+#include "my_vector.h"
+
+namespace my {
+
+// map on a B-tree, with the (key, value) pairs of a node stored side by
+// side. Any insert or erase invalidates iterators, so there are no node
+// handles.
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          size_t NodeBytes = 256>
+class btree_map
+    : public btree<std::pair<Key, T>, pair_first_compare<Key, T, Compare>,
+                   NodeBytes> {
+  using tree_type = btree<std::pair<Key, T>,
+                          pair_first_compare<Key, T, Compare>, NodeBytes>;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using key_compare = Compare;
+  using value_type = std::pair<key_type, mapped_type>;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using iterator = typename tree_type::iterator;
+  using const_iterator = typename tree_type::const_iterator;
+  using size_type = size_t;
+
+  btree_map() : tree_type() {}
+  explicit btree_map(const Compare &comp)
+      : tree_type(pair_first_compare<Key, T, Compare>{comp}) {}
+  btree_map(std::initializer_list<value_type> const &items);
+
+  template <typename InputIt>
+  static btree_map from_sorted(InputIt first, InputIt last,
+                               const Compare &comp = Compare());
+
+  key_compare key_comp() const;
+
+  T &at(const Key &key);
+  // A missing key is inserted with a value-initialised T by the same
+  // lookup that finds where it goes.
+  T &operator[](const Key &key);
+  T &operator[](Key &&key);
+
+  std::pair<iterator, bool> insert(const value_type &value);
+  std::pair<iterator, bool> insert(const Key &key, const T &obj);
+  iterator insert(iterator hint, const value_type &value);
+
+  // One lookup each. try_emplace builds the value from args only when key
+  // is missing; insert_or_assign otherwise assigns obj to the value found.
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args);
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const Key &key, M &&obj);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(Key &&key, M &&obj);
+
+  bool contains(const Key &key);
+
+  template <typename... Args>
+  Vector<std::pair<iterator, bool>> insert_many(Args &&...args);
+
+  iterator find(const Key &key);
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key);
+  iterator lower_bound(const Key &key);
+  iterator upper_bound(const Key &key);
+  std::pair<iterator, iterator> equal_range(const Key &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key);
+
+ private:
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_key(K &&key, Args &&...args);
+  template <typename K, typename M>
+  std::pair<iterator, bool> assign_key(K &&key, M &&obj);
+};
+
+// A repeated key keeps the last value, as if the items were assigned one
+// after the other.
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+btree_map<Key, T, Compare, NodeBytes>::btree_map(
+    const std::initializer_list<value_type> &items) {
+  Vector<value_type> buf;
+  buf.insert(buf.end(), items.begin(), items.end());
+  this->assign_buffer(buf, true);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename InputIt>
+btree_map<Key, T, Compare, NodeBytes>
+btree_map<Key, T, Compare, NodeBytes>::from_sorted(InputIt first,
+                                                   InputIt last,
+                                                   const Compare &comp) {
+  btree_map res(comp);
+  res.assign_sorted(first, last);
+  return res;
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+typename btree_map<Key, T, Compare, NodeBytes>::key_compare
+btree_map<Key, T, Compare, NodeBytes>::key_comp() const {
+  return this->comp_.comp;
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+T &btree_map<Key, T, Compare, NodeBytes>::at(const Key &key) {
+  iterator it = this->find_iter(key);
+  if (it == this->end()) throw std::runtime_error("Error: No such key");
+  return (*it).second;
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+T &btree_map<Key, T, Compare, NodeBytes>::operator[](const Key &key) {
+  return (*try_emplace_key(key).first).second;
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+T &btree_map<Key, T, Compare, NodeBytes>::operator[](Key &&key) {
+  return (*try_emplace_key(std::move(key)).first).second;
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+typename std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator,
+                   bool>
+btree_map<Key, T, Compare, NodeBytes>::insert(const value_type &value) {
+  typename btree_map::insert_position pos =
+      this->find_insert_pos(value.first);
+
+  if (pos.found)
+    return std::pair<iterator, bool>(iterator(pos.nd, pos.pos), false);
+  return std::pair<iterator, bool>(this->insert_at(pos, value), true);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+typename std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator,
+                   bool>
+btree_map<Key, T, Compare, NodeBytes>::insert(const Key &key, const T &obj) {
+  return try_emplace_key(key, obj);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+typename btree_map<Key, T, Compare, NodeBytes>::iterator
+btree_map<Key, T, Compare, NodeBytes>::insert(iterator hint,
+                                              const value_type &value) {
+  typename btree_map::insert_position pos =
+      this->find_hint_pos(hint, value.first);
+
+  if (pos.found) return iterator(pos.nd, pos.pos);
+  return this->insert_at(pos, value);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename... Args>
+std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator, bool>
+btree_map<Key, T, Compare, NodeBytes>::try_emplace(const Key &key,
+                                                   Args &&...args) {
+  return try_emplace_key(key, std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename... Args>
+std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator, bool>
+btree_map<Key, T, Compare, NodeBytes>::try_emplace(Key &&key, Args &&...args) {
+  return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename M>
+std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator, bool>
+btree_map<Key, T, Compare, NodeBytes>::insert_or_assign(const Key &key,
+                                                        M &&obj) {
+  return assign_key(key, std::forward<M>(obj));
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename M>
+std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator, bool>
+btree_map<Key, T, Compare, NodeBytes>::insert_or_assign(Key &&key, M &&obj) {
+  return assign_key(std::move(key), std::forward<M>(obj));
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+bool btree_map<Key, T, Compare, NodeBytes>::contains(const Key &key) {
+  return this->find_iter(key) != this->end();
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+typename btree_map<Key, T, Compare, NodeBytes>::iterator
+btree_map<Key, T, Compare, NodeBytes>::find(const Key &key) {
+  return this->find_iter(key);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree_map<Key, T, Compare, NodeBytes>::iterator
+btree_map<Key, T, Compare, NodeBytes>::find(const K &key) {
+  return this->find_iter(key);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+bool btree_map<Key, T, Compare, NodeBytes>::contains(const K &key) {
+  return this->find_iter(key) != this->end();
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+typename btree_map<Key, T, Compare, NodeBytes>::iterator
+btree_map<Key, T, Compare, NodeBytes>::lower_bound(const Key &key) {
+  return this->lower_bound_iter(key);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+typename btree_map<Key, T, Compare, NodeBytes>::iterator
+btree_map<Key, T, Compare, NodeBytes>::upper_bound(const Key &key) {
+  return this->upper_bound_iter(key);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator,
+          typename btree_map<Key, T, Compare, NodeBytes>::iterator>
+btree_map<Key, T, Compare, NodeBytes>::equal_range(const Key &key) {
+  return this->equal_range_iter(key);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree_map<Key, T, Compare, NodeBytes>::iterator
+btree_map<Key, T, Compare, NodeBytes>::lower_bound(const K &key) {
+  return this->lower_bound_iter(key);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree_map<Key, T, Compare, NodeBytes>::iterator
+btree_map<Key, T, Compare, NodeBytes>::upper_bound(const K &key) {
+  return this->upper_bound_iter(key);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator,
+          typename btree_map<Key, T, Compare, NodeBytes>::iterator>
+btree_map<Key, T, Compare, NodeBytes>::equal_range(const K &key) {
+  return this->equal_range_iter(key);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename... Args>
+Vector<std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator,
+                 bool>>
+btree_map<Key, T, Compare, NodeBytes>::insert_many(Args &&...args) {
+  Vector<std::pair<iterator, bool>> res;
+
+  for (const auto &arg : {args...}) res.push_back(insert(arg));
+
+  return res;
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename... Args>
+std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator, bool>
+btree_map<Key, T, Compare, NodeBytes>::try_emplace_key(K &&key,
+                                                       Args &&...args) {
+  typename btree_map::insert_position pos = this->find_insert_pos(key);
+
+  if (pos.found)
+    return std::pair<iterator, bool>(iterator(pos.nd, pos.pos), false);
+  return std::pair<iterator, bool>(
+      this->insert_at(pos, std::piecewise_construct,
+                      std::forward_as_tuple(std::forward<K>(key)),
+                      std::forward_as_tuple(std::forward<Args>(args)...)),
+      true);
+}
+
+template <typename Key, typename T, typename Compare, size_t NodeBytes>
+template <typename K, typename M>
+std::pair<typename btree_map<Key, T, Compare, NodeBytes>::iterator, bool>
+btree_map<Key, T, Compare, NodeBytes>::assign_key(K &&key, M &&obj) {
+  typename btree_map::insert_position pos = this->find_insert_pos(key);
+
+  if (pos.found) {
+    pos.nd->values[pos.pos].second = std::forward<M>(obj);
+    return std::pair<iterator, bool>(iterator(pos.nd, pos.pos), false);
+  }
+  return std::pair<iterator, bool>(
+      this->insert_at(pos, std::forward<K>(key), std::forward<M>(obj)), true);
+}
+
+}  // namespace my
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef _MY_CONTAINER_BTREE_MULTISET_H
+#define _MY_CONTAINER_BTREE_MULTISET_H
+
+#include "my_btree.h"
+#include "my_rbtree.h"
+#include "my_vector.h"
+
+namespace my {
+
+// multiset on a B-tree. As in multiset, equal keys share one slot with a
+// counter, and size() counts every copy.
+template <typename Key, typename Compare = std::less<Key>,
+          size_t NodeBytes = 256>
+class btree_multiset
+    : public btree<std::pair<Key, int>, pair_first_compare<Key, int, Compare>,
+                   NodeBytes> {
+  using tree_type = btree<std::pair<Key, int>,
+                          pair_first_compare<Key, int, Compare>, NodeBytes>;
+
+ public:
+  using key_type = Key;
+  using key_compare = Compare;
+  using value_type = std::pair<Key, int>;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using const_iterator = typename tree_type::const_iterator;
+  using iterator = typename tree_type::iterator;
+  using size_type = size_t;
+
+  btree_multiset() : tree_type() {}
+  explicit btree_multiset(const Compare &comp)
+      : tree_type(pair_first_compare<Key, int, Compare>{comp}) {}
+  btree_multiset(std::initializer_list<key_type> const &items);
+
+  template <typename InputIt>
+  static btree_multiset from_sorted(InputIt first, InputIt last,
+                                    const Compare &comp = Compare());
+  template <typename InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
+  key_compare key_comp() const;
+
+  iterator insert(const Key &value);
+  iterator insert(iterator hint, const Key &value);
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args);
+  bool contains(const Key &key);
+  void erase(iterator pos);
+  void merge(btree_multiset &other);
+  size_type count(const Key &key);
+
+  template <typename... Args>
+  Vector<std::pair<iterator, bool>> insert_many(Args &&...args);
+  iterator find(const Key &key);
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K &key);
+  iterator lower_bound(const Key &key);
+  iterator upper_bound(const Key &key);
+  std::pair<iterator, iterator> equal_range(const Key &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key);
+};
+
+template <typename Key, typename Compare, size_t NodeBytes>
+btree_multiset<Key, Compare, NodeBytes>::btree_multiset(
+    std::initializer_list<key_type> const &items) {
+  assign_sorted(items.begin(), items.end());
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename InputIt>
+btree_multiset<Key, Compare, NodeBytes>
+btree_multiset<Key, Compare, NodeBytes>::from_sorted(InputIt first,
+                                                     InputIt last,
+                                                     const Compare &comp) {
+  btree_multiset res(comp);
+  res.assign_sorted(first, last);
+  return res;
+}
+
+// Takes keys rather than (key, count) pairs: runs of equivalent keys are
+// folded into one counted slot each.
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename InputIt>
+void btree_multiset<Key, Compare, NodeBytes>::assign_sorted(InputIt first,
+                                                            InputIt last) {
+  const Compare &comp = this->comp_.comp;
+  Vector<key_type> keys;
+  keys.insert(keys.end(), first, last);
+  if (!std::is_sorted(keys.begin(), keys.end(), comp))
+    std::sort(keys.begin(), keys.end(), comp);
+
+  Vector<value_type> runs;
+  for (key_type &key : keys) {
+    if (!runs.empty() && !comp(runs.back().first, key))
+      runs[runs.size() - 1].second++;
+    else
+      runs.push_back(value_type(std::move(key), 1));
+  }
+  this->assign_unique_sorted(std::make_move_iterator(runs.begin()),
+                             runs.size());
+  this->count_ = keys.size();
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+typename btree_multiset<Key, Compare, NodeBytes>::key_compare
+btree_multiset<Key, Compare, NodeBytes>::key_comp() const {
+  return this->comp_.comp;
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::insert(const Key &value) {
+  typename btree_multiset::insert_position pos =
+      this->find_insert_pos(value);
+
+  if (pos.found) {
+    pos.nd->values[pos.pos].second++;
+    this->count_++;
+    return iterator(pos.nd, pos.pos);
+  }
+  return this->insert_at(pos, value, 1);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::insert(iterator hint,
+                                                const Key &value) {
+  return emplace_hint(hint, value);
+}
+
+// The arguments build a key, not a (key, count) pair.
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename... Args>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::emplace_hint(iterator hint,
+                                                      Args &&...args) {
+  Key key(std::forward<Args>(args)...);
+  typename btree_multiset::insert_position pos =
+      this->find_hint_pos(hint, key);
+
+  if (pos.found) {
+    pos.nd->values[pos.pos].second++;
+    this->count_++;
+    return iterator(pos.nd, pos.pos);
+  }
+  return this->insert_at(pos, std::move(key), 1);
+}
+
+// Drops one copy of the key; the slot goes once its last copy does.
+template <typename Key, typename Compare, size_t NodeBytes>
+void btree_multiset<Key, Compare, NodeBytes>::erase(iterator pos) {
+  if (pos == this->end()) return;
+
+  if ((*pos).second > 1) {
+    (*pos).second--;
+    this->count_--;
+  } else {
+    tree_type::erase(pos);
+  }
+}
+
+// size() counts every copy, so both sizes are settled from the counters of
+// what is left in other.
+template <typename Key, typename Compare, size_t NodeBytes>
+void btree_multiset<Key, Compare, NodeBytes>::merge(btree_multiset &other) {
+  if (this == &other) return;
+  size_type total = this->count_ + other.count_;
+  tree_type::merge(other);
+
+  other.count_ = 0;
+  for (auto it = other.begin(); it != other.end(); ++it)
+    other.count_ += (*it).second;
+  this->count_ = total - other.count_;
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+typename btree_multiset<Key, Compare, NodeBytes>::size_type
+btree_multiset<Key, Compare, NodeBytes>::count(const Key &key) {
+  iterator it = this->find_iter(key);
+  return it != this->end() ? (*it).second : 0;
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+bool btree_multiset<Key, Compare, NodeBytes>::contains(const Key &key) {
+  return this->find_iter(key) != this->end();
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::find(const Key &key) {
+  return this->find_iter(key);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::find(const K &key) {
+  return this->find_iter(key);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+bool btree_multiset<Key, Compare, NodeBytes>::contains(const K &key) {
+  return this->find_iter(key) != this->end();
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::lower_bound(const Key &key) {
+  return this->lower_bound_iter(key);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::upper_bound(const Key &key) {
+  return this->upper_bound_iter(key);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+std::pair<typename btree_multiset<Key, Compare, NodeBytes>::iterator,
+          typename btree_multiset<Key, Compare, NodeBytes>::iterator>
+btree_multiset<Key, Compare, NodeBytes>::equal_range(const Key &key) {
+  return this->equal_range_iter(key);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::lower_bound(const K &key) {
+  return this->lower_bound_iter(key);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree_multiset<Key, Compare, NodeBytes>::iterator
+btree_multiset<Key, Compare, NodeBytes>::upper_bound(const K &key) {
+  return this->upper_bound_iter(key);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+std::pair<typename btree_multiset<Key, Compare, NodeBytes>::iterator,
+          typename btree_multiset<Key, Compare, NodeBytes>::iterator>
+btree_multiset<Key, Compare, NodeBytes>::equal_range(const K &key) {
+  return this->equal_range_iter(key);
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename K, typename C, typename>
+typename btree_multiset<Key, Compare, NodeBytes>::size_type
+btree_multiset<Key, Compare, NodeBytes>::count(const K &key) {
+  iterator it = this->find_iter(key);
+  return it != this->end() ? (*it).second : 0;
+}
+
+template <typename Key, typename Compare, size_t NodeBytes>
+template <typename... Args>
+Vector<std::pair<typename btree_multiset<Key, Compare, NodeBytes>::iterator,
+                 bool>>
+btree_multiset<Key, Compare, NodeBytes>::insert_many(Args &&...args) {
+  Vector<std::pair<iterator, bool>> res;
+
+  size_type count = sizeof...(Args);
+  if (count == 0) throw std::runtime_error("Error: Zero args");
+  Key tmp[sizeof...(Args)] = {std::forward<Args>(args)...};
+  for (size_type i = 0; i < count; i++) {
+    res.push_back(std::pair(insert(tmp[i]), true));
+  }
+
+  return res;
+}
+
+}  // namespace my
+
+#endif
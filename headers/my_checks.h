@@ -0,0 +1,40 @@
+#ifndef _MY_CONTAINER_CHECKS_H
+#define _MY_CONTAINER_CHECKS_H
+
+#include <cstdio>
+#include <cstdlib>
+
+// Bounds checking policy for the unchecked accessors (operator[], front(),
+// back()) of the contiguous containers. Define MY_CONTAINERS_CHECKED to 1
+// to turn the checks on or to 0 to turn them off; by default they follow
+// assert() and are compiled out when NDEBUG is defined. at() always
+// checks and throws regardless of this setting.
+#ifndef MY_CONTAINERS_CHECKED
+#ifdef NDEBUG
+#define MY_CONTAINERS_CHECKED 0
+#else
+#define MY_CONTAINERS_CHECKED 1
+#endif
+#endif
+
+#if MY_CONTAINERS_CHECKED
+#define MY_CONTAINERS_ASSERT(cond, msg) \
+  ((cond) ? (void)0 : ::my::detail::check_failed(msg, __FILE__, __LINE__))
+#else
+#define MY_CONTAINERS_ASSERT(cond, msg) ((void)0)
+#endif
+
+namespace my {
+namespace detail {
+
+[[noreturn]] inline void check_failed(const char *msg, const char *file,
+                                      int line) {
+  std::fprintf(stderr, "%s:%d: my containers check failed: %s\n", file, line,
+               msg);
+  std::abort();
+}
+
+}  // namespace detail
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_CHECKS_H
@@ -0,0 +1,638 @@
+#ifndef _MY_CONTAINER_FLAT_MAP_H
+#define _MY_CONTAINER_FLAT_MAP_H
+
+#include <tuple>
+
+#include "my_flat_set.h"
+#include "my_rbtree.h"
+#include "my_vector.h"
+
+namespace my {
+
+// map kept as two parallel sorted Vectors, one of keys and one of mapped
+// values, so that a lookup only walks the keys and fits more of them per
+// cache line. As in flat_set, inserting or erasing is O(n) and
+// invalidates iterators. An element is not stored as a pair, so
+// dereferencing an iterator gives a pair of references.
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class flat_map {
+ public:
+  class iterator;
+
+  using key_type = Key;
+  using mapped_type = T;
+  using key_compare = Compare;
+  using value_compare = pair_first_compare<Key, T, Compare>;
+  using value_type = std::pair<key_type, mapped_type>;
+  using reference = std::pair<const key_type &, mapped_type &>;
+  using const_reference = const value_type &;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using size_type = size_t;
+
+  flat_map() = default;
+  explicit flat_map(const Compare &comp) : comp_(comp) {}
+  flat_map(std::initializer_list<value_type> const &items);
+  flat_map(const flat_map &other) = default;
+  flat_map(flat_map &&other) noexcept = default;
+
+  flat_map &operator=(flat_map &&other) noexcept = default;
+
+  template <typename InputIt>
+  static flat_map from_sorted(InputIt first, InputIt last,
+                              const Compare &comp = Compare());
+
+  iterator begin();
+  iterator end();
+  reverse_iterator rbegin();
+  reverse_iterator rend();
+
+  bool empty();
+  size_type size();
+  size_type max_size();
+  void reserve(size_type size);
+  key_compare key_comp() const;
+  value_compare value_comp() const;
+
+  T &at(const Key &key);
+  // A missing key is inserted with a value-initialised T by the same
+  // lookup that finds where it goes.
+  T &operator[](const Key &key);
+  T &operator[](Key &&key);
+
+  void clear();
+  std::pair<iterator, bool> insert(const value_type &value);
+  std::pair<iterator, bool> insert(const Key &key, const T &obj);
+  iterator insert(iterator hint, const value_type &value);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args);
+
+  // One lookup each. try_emplace builds the value from args only when key
+  // is missing; insert_or_assign otherwise assigns obj to the value found.
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args);
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const Key &key, M &&obj);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(Key &&key, M &&obj);
+  void erase(iterator pos);
+  void swap(flat_map &other);
+
+  // Moves over the elements of other whose keys this map lacks and leaves
+  // the rest in other, in one linear pass over both.
+  void merge(flat_map &other);
+
+  // Replaces the contents with the pairs in [first, last), sorting them by
+  // key first unless they already are. Of equivalent keys the first one is
+  // kept.
+  template <typename InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
+  bool contains(const Key &key);
+  iterator find(const Key &key);
+  iterator lower_bound(const Key &key);
+  iterator upper_bound(const Key &key);
+  std::pair<iterator, iterator> equal_range(const Key &key);
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key);
+
+  template <typename... Args>
+  Vector<std::pair<iterator, bool>> insert_many(Args &&...args);
+
+  // The same position in both vectors.
+  class iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::pair<Key, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const Key &, T &>;
+
+    // operator-> hands out the pair of references by value.
+    struct pointer {
+      reference ref;
+      reference *operator->() { return &ref; }
+    };
+
+    iterator() = default;
+    iterator(Key *key, T *value);
+    reference operator*() const;
+    pointer operator->() const;
+    bool operator==(const iterator &other) const;
+    bool operator!=(const iterator &other) const;
+    iterator &operator++();
+    iterator operator++(int);
+    iterator &operator--();
+    iterator operator--(int);
+
+   private:
+    friend class flat_map;
+
+    Key *key_ = nullptr;
+    T *value_ = nullptr;
+  };
+
+ private:
+  template <typename K>
+  size_type lower_index(const K &key);
+  template <typename K>
+  size_type upper_index(const K &key);
+  template <typename K>
+  iterator find_iter(const K &key);
+  size_type insert_index(const Key &key, bool &found);
+  template <typename K, typename... Args>
+  iterator insert_at(size_type i, K &&key, Args &&...args);
+  iterator iter_at(size_type i);
+  void assign_buffer(Vector<value_type> &buf, bool keep_last);
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_key(K &&key, Args &&...args);
+  template <typename K, typename M>
+  std::pair<iterator, bool> assign_key(K &&key, M &&obj);
+
+  Vector<Key> keys_;
+  Vector<T> values_;
+  Compare comp_;
+};
+
+// A repeated key keeps the last value, as if the items were assigned one
+// after the other.
+template <typename Key, typename T, typename Compare>
+flat_map<Key, T, Compare>::flat_map(
+    const std::initializer_list<value_type> &items) {
+  Vector<value_type> buf;
+  buf.insert(buf.end(), items.begin(), items.end());
+  assign_buffer(buf, true);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename InputIt>
+flat_map<Key, T, Compare> flat_map<Key, T, Compare>::from_sorted(
+    InputIt first, InputIt last, const Compare &comp) {
+  flat_map res(comp);
+  res.assign_sorted(first, last);
+  return res;
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::begin() {
+  return iter_at(0);
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator flat_map<Key, T, Compare>::end() {
+  return iter_at(keys_.size());
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::reverse_iterator
+flat_map<Key, T, Compare>::rbegin() {
+  return reverse_iterator(end());
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::reverse_iterator
+flat_map<Key, T, Compare>::rend() {
+  return reverse_iterator(begin());
+}
+
+template <typename Key, typename T, typename Compare>
+inline bool flat_map<Key, T, Compare>::empty() {
+  return keys_.empty();
+}
+
+template <typename Key, typename T, typename Compare>
+inline size_t flat_map<Key, T, Compare>::size() {
+  return keys_.size();
+}
+
+template <typename Key, typename T, typename Compare>
+inline size_t flat_map<Key, T, Compare>::max_size() {
+  return std::min(keys_.max_size(), values_.max_size());
+}
+
+template <typename Key, typename T, typename Compare>
+void flat_map<Key, T, Compare>::reserve(size_type size) {
+  keys_.reserve(size);
+  values_.reserve(size);
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::key_compare
+flat_map<Key, T, Compare>::key_comp() const {
+  return comp_;
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::value_compare
+flat_map<Key, T, Compare>::value_comp() const {
+  return value_compare{comp_};
+}
+
+template <typename Key, typename T, typename Compare>
+T &flat_map<Key, T, Compare>::at(const Key &key) {
+  iterator it = find_iter(key);
+  if (it == end()) throw std::runtime_error("Error: No such key");
+  return *it.value_;
+}
+
+template <typename Key, typename T, typename Compare>
+T &flat_map<Key, T, Compare>::operator[](const Key &key) {
+  return (*try_emplace_key(key).first).second;
+}
+
+template <typename Key, typename T, typename Compare>
+T &flat_map<Key, T, Compare>::operator[](Key &&key) {
+  return (*try_emplace_key(std::move(key)).first).second;
+}
+
+template <typename Key, typename T, typename Compare>
+void flat_map<Key, T, Compare>::clear() {
+  keys_.clear();
+  values_.clear();
+}
+
+template <typename Key, typename T, typename Compare>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::insert(const value_type &value) {
+  return insert(value.first, value.second);
+}
+
+template <typename Key, typename T, typename Compare>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::insert(const Key &key, const T &obj) {
+  return try_emplace_key(key, obj);
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator flat_map<Key, T, Compare>::insert(
+    iterator hint, const value_type &value) {
+  size_type i = hint.key_ - keys_.data();
+  if ((i == keys_.size() || comp_(value.first, keys_[i])) &&
+      (i == 0 || comp_(keys_[i - 1], value.first)))
+    return insert_at(i, value.first, value.second);
+  return insert(value).first;
+}
+
+// The pair is built first since its key is needed to place it.
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::emplace(Args &&...args) {
+  value_type value(std::forward<Args>(args)...);
+  return try_emplace_key(std::move(value.first), std::move(value.second));
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::try_emplace(const Key &key, Args &&...args) {
+  return try_emplace_key(key, std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::try_emplace(Key &&key, Args &&...args) {
+  return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename M>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::insert_or_assign(const Key &key, M &&obj) {
+  return assign_key(key, std::forward<M>(obj));
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename M>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::insert_or_assign(Key &&key, M &&obj) {
+  return assign_key(std::move(key), std::forward<M>(obj));
+}
+
+template <typename Key, typename T, typename Compare>
+void flat_map<Key, T, Compare>::erase(iterator pos) {
+  if (pos == end()) return;
+  size_type i = pos.key_ - keys_.data();
+  keys_.erase(keys_.begin() + i);
+  values_.erase(values_.begin() + i);
+}
+
+template <typename Key, typename T, typename Compare>
+void flat_map<Key, T, Compare>::swap(flat_map &other) {
+  keys_.swap(other.keys_);
+  values_.swap(other.values_);
+  std::swap(comp_, other.comp_);
+}
+
+template <typename Key, typename T, typename Compare>
+void flat_map<Key, T, Compare>::merge(flat_map &other) {
+  if (this == &other || other.empty()) return;
+
+  flat_map merged(comp_);
+  flat_map rest(comp_);
+  merged.reserve(size() + other.size());
+  size_type a = 0;
+  size_type b = 0;
+  auto take = [](flat_map &to, flat_map &from, size_type &i) {
+    to.keys_.push_back(std::move(from.keys_[i]));
+    to.values_.push_back(std::move(from.values_[i]));
+    i++;
+  };
+  while (a < size() && b < other.size()) {
+    if (comp_(keys_[a], other.keys_[b])) {
+      take(merged, *this, a);
+    } else if (comp_(other.keys_[b], keys_[a])) {
+      take(merged, other, b);
+    } else {
+      take(merged, *this, a);
+      take(rest, other, b);
+    }
+  }
+  while (a < size()) take(merged, *this, a);
+  while (b < other.size()) take(merged, other, b);
+
+  swap(merged);
+  other.swap(rest);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename InputIt>
+void flat_map<Key, T, Compare>::assign_sorted(InputIt first, InputIt last) {
+  Vector<value_type> buf;
+  buf.insert(buf.end(), first, last);
+  assign_buffer(buf, false);
+}
+
+template <typename Key, typename T, typename Compare>
+bool flat_map<Key, T, Compare>::contains(const Key &key) {
+  return find_iter(key) != end();
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator flat_map<Key, T, Compare>::find(
+    const Key &key) {
+  return find_iter(key);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+typename flat_map<Key, T, Compare>::iterator flat_map<Key, T, Compare>::find(
+    const K &key) {
+  return find_iter(key);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+bool flat_map<Key, T, Compare>::contains(const K &key) {
+  return find_iter(key) != end();
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::lower_bound(const Key &key) {
+  return iter_at(lower_index(key));
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::upper_bound(const Key &key) {
+  return iter_at(upper_index(key));
+}
+
+template <typename Key, typename T, typename Compare>
+std::pair<typename flat_map<Key, T, Compare>::iterator,
+          typename flat_map<Key, T, Compare>::iterator>
+flat_map<Key, T, Compare>::equal_range(const Key &key) {
+  size_type i = lower_index(key);
+  size_type j = i < keys_.size() && !comp_(key, keys_[i]) ? i + 1 : i;
+  return {iter_at(i), iter_at(j)};
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::lower_bound(const K &key) {
+  return iter_at(lower_index(key));
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::upper_bound(const K &key) {
+  return iter_at(upper_index(key));
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+std::pair<typename flat_map<Key, T, Compare>::iterator,
+          typename flat_map<Key, T, Compare>::iterator>
+flat_map<Key, T, Compare>::equal_range(const K &key) {
+  size_type i = lower_index(key);
+  size_type j = i < keys_.size() && !comp_(key, keys_[i]) ? i + 1 : i;
+  return {iter_at(i), iter_at(j)};
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+Vector<std::pair<typename flat_map<Key, T, Compare>::iterator, bool>>
+flat_map<Key, T, Compare>::insert_many(Args &&...args) {
+  Vector<std::pair<iterator, bool>> res;
+
+  for (const auto &arg : {args...}) res.push_back(insert(arg));
+
+  return res;
+}
+
+template <typename Key, typename T, typename Compare>
+flat_map<Key, T, Compare>::iterator::iterator(Key *key, T *value)
+    : key_(key), value_(value) {}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator::reference
+flat_map<Key, T, Compare>::iterator::operator*() const {
+  return reference(*key_, *value_);
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator::pointer
+flat_map<Key, T, Compare>::iterator::operator->() const {
+  return pointer{**this};
+}
+
+template <typename Key, typename T, typename Compare>
+inline bool flat_map<Key, T, Compare>::iterator::operator==(
+    const iterator &other) const {
+  return key_ == other.key_;
+}
+
+template <typename Key, typename T, typename Compare>
+inline bool flat_map<Key, T, Compare>::iterator::operator!=(
+    const iterator &other) const {
+  return key_ != other.key_;
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator &
+flat_map<Key, T, Compare>::iterator::operator++() {
+  ++key_;
+  ++value_;
+  return *this;
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::iterator::operator++(int) {
+  iterator tmp = *this;
+  ++*this;
+  return tmp;
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator &
+flat_map<Key, T, Compare>::iterator::operator--() {
+  --key_;
+  --value_;
+  return *this;
+}
+
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::iterator::operator--(int) {
+  iterator tmp = *this;
+  --*this;
+  return tmp;
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K>
+inline typename flat_map<Key, T, Compare>::size_type
+flat_map<Key, T, Compare>::lower_index(const K &key) {
+  return detail::branchless_lower_bound(keys_.data(), keys_.size(), key,
+                                        comp_);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K>
+inline typename flat_map<Key, T, Compare>::size_type
+flat_map<Key, T, Compare>::upper_index(const K &key) {
+  size_type i = lower_index(key);
+  return i < keys_.size() && !comp_(key, keys_[i]) ? i + 1 : i;
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::find_iter(const K &key) {
+  size_type i = lower_index(key);
+  if (i < keys_.size() && !comp_(key, keys_[i])) return iter_at(i);
+  return end();
+}
+
+// Keys past the current maximum go to the end without a search.
+template <typename Key, typename T, typename Compare>
+typename flat_map<Key, T, Compare>::size_type
+flat_map<Key, T, Compare>::insert_index(const Key &key, bool &found) {
+  size_type n = keys_.size();
+  found = false;
+  if (n == 0 || comp_(keys_[n - 1], key)) return n;
+
+  size_type i = lower_index(key);
+  found = !comp_(key, keys_[i]);
+  return i;
+}
+
+// The value is built before either vector moves, as args may refer into
+// this map. The key goes in last, so a failed insert leaves both vectors
+// as they were or the value vector one element longer, which is undone.
+template <typename Key, typename T, typename Compare>
+template <typename K, typename... Args>
+typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::insert_at(size_type i, K &&key, Args &&...args) {
+  T value(std::forward<Args>(args)...);
+  values_.insert_many(values_.begin() + i, std::move(value));
+  try {
+    keys_.insert_many(keys_.begin() + i, std::forward<K>(key));
+  } catch (...) {
+    values_.erase(values_.begin() + i);
+    throw;
+  }
+  return iter_at(i);
+}
+
+template <typename Key, typename T, typename Compare>
+inline typename flat_map<Key, T, Compare>::iterator
+flat_map<Key, T, Compare>::iter_at(size_type i) {
+  return iterator(keys_.data() + i, values_.data() + i);
+}
+
+// Sorts the pairs by key and drops repeated keys, then deals the keys and
+// the values out into their own vectors.
+template <typename Key, typename T, typename Compare>
+void flat_map<Key, T, Compare>::assign_buffer(Vector<value_type> &buf,
+                                              bool keep_last) {
+  value_compare comp{comp_};
+  if (!std::is_sorted(buf.begin(), buf.end(), comp))
+    std::stable_sort(buf.begin(), buf.end(), comp);
+
+  Vector<Key> keys;
+  Vector<T> values;
+  keys.reserve(buf.size());
+  values.reserve(buf.size());
+  for (size_type i = 0; i < buf.size(); i++) {
+    if (!keys.empty() && !comp_(keys[keys.size() - 1], buf[i].first)) {
+      if (keep_last) values[values.size() - 1] = std::move(buf[i].second);
+    } else {
+      keys.push_back(std::move(buf[i].first));
+      values.push_back(std::move(buf[i].second));
+    }
+  }
+  keys_ = std::move(keys);
+  values_ = std::move(values);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename... Args>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::try_emplace_key(K &&key, Args &&...args) {
+  bool found;
+  size_type i = insert_index(key, found);
+
+  if (found) return std::pair<iterator, bool>(iter_at(i), false);
+  return std::pair<iterator, bool>(
+      insert_at(i, std::forward<K>(key), std::forward<Args>(args)...), true);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename M>
+std::pair<typename flat_map<Key, T, Compare>::iterator, bool>
+flat_map<Key, T, Compare>::assign_key(K &&key, M &&obj) {
+  bool found;
+  size_type i = insert_index(key, found);
+
+  if (found) {
+    values_[i] = std::forward<M>(obj);
+    return std::pair<iterator, bool>(iter_at(i), false);
+  }
+  return std::pair<iterator, bool>(
+      insert_at(i, std::forward<K>(key), std::forward<M>(obj)), true);
+}
+
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_FLAT_MAP_H
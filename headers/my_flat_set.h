@@ -0,0 +1,409 @@
+#ifndef _MY_CONTAINER_FLAT_SET_H
+#define _MY_CONTAINER_FLAT_SET_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "my_vector.h"
+
+namespace my {
+
+namespace detail {
+
+// Index of the first of the n sorted elements at base that is not ordered
+// before key. The halving loop has no data-dependent branch, so the
+// compiler can use a conditional move and the CPU has nothing to
+// mispredict; the number of iterations only depends on n.
+template <typename It, typename K, typename Compare>
+size_t branchless_lower_bound(It base, size_t n, const K &key,
+                              const Compare &comp) {
+  if (n == 0) return 0;
+  It first = base;
+  while (n > 1) {
+    size_t half = n / 2;
+    base = comp(base[half], key) ? base + half : base;
+    n -= half;
+  }
+  return (base - first) + comp(*base, key);
+}
+
+}  // namespace detail
+
+// set kept as one sorted Vector. A lookup binary-searches a single array,
+// so for tables built once and read often it beats any node-based tree in
+// speed and memory. Inserting or erasing shifts the elements after the
+// position, which is O(n) and invalidates iterators.
+template <typename T, typename Compare = std::less<T>>
+class flat_set {
+ public:
+  using key_type = T;
+  using value_type = T;
+  using key_compare = Compare;
+  using value_compare = Compare;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = typename Vector<T>::iterator;
+  using const_iterator = typename Vector<T>::const_iterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using size_type = size_t;
+
+  flat_set() = default;
+  explicit flat_set(const Compare &comp) : comp_(comp) {}
+  flat_set(std::initializer_list<T> const &items);
+  flat_set(const flat_set &other) = default;
+  flat_set(flat_set &&other) noexcept = default;
+
+  flat_set &operator=(flat_set &&other) noexcept = default;
+
+  template <typename InputIt>
+  static flat_set from_sorted(InputIt first, InputIt last,
+                              const Compare &comp = Compare());
+
+  iterator begin();
+  iterator end();
+  reverse_iterator rbegin();
+  reverse_iterator rend();
+
+  bool empty();
+  size_type size();
+  size_type max_size();
+  void reserve(size_type size);
+  key_compare key_comp() const;
+  value_compare value_comp() const;
+
+  void clear();
+  std::pair<iterator, bool> insert(value_type key);
+  // key goes right before hint when it belongs there, which spares the
+  // search.
+  iterator insert(iterator hint, value_type key);
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args);
+  void erase(iterator pos);
+  void swap(flat_set &other);
+
+  // Moves over the elements of other that this set lacks and leaves the
+  // rest in other, in one linear pass over both.
+  void merge(flat_set &other);
+
+  // Replaces the contents with [first, last), sorting it first unless it
+  // already is. Of equivalent elements the first one is kept.
+  template <typename InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
+  iterator find(const_reference key);
+  bool contains(const_reference key);
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key);
+
+  // Half-open bounds by binary search over the sorted keys.
+  iterator lower_bound(const_reference key);
+  iterator upper_bound(const_reference key);
+  std::pair<iterator, iterator> equal_range(const_reference key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key);
+
+  template <typename... Args>
+  Vector<std::pair<iterator, bool>> insert_many(Args &&...args);
+
+ private:
+  template <typename K>
+  size_type lower_index(const K &key);
+  template <typename K>
+  size_type upper_index(const K &key);
+  template <typename K>
+  iterator find_iter(const K &key);
+
+  Vector<T> keys_;
+  Compare comp_;
+};
+
+template <typename T, typename Compare>
+flat_set<T, Compare>::flat_set(std::initializer_list<T> const &items) {
+  assign_sorted(items.begin(), items.end());
+}
+
+template <typename T, typename Compare>
+template <typename InputIt>
+flat_set<T, Compare> flat_set<T, Compare>::from_sorted(InputIt first,
+                                                       InputIt last,
+                                                       const Compare &comp) {
+  flat_set res(comp);
+  res.assign_sorted(first, last);
+  return res;
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::begin() {
+  return keys_.begin();
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::end() {
+  return keys_.end();
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::reverse_iterator
+flat_set<T, Compare>::rbegin() {
+  return reverse_iterator(end());
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::reverse_iterator flat_set<T, Compare>::rend() {
+  return reverse_iterator(begin());
+}
+
+template <typename T, typename Compare>
+inline bool flat_set<T, Compare>::empty() {
+  return keys_.empty();
+}
+
+template <typename T, typename Compare>
+inline size_t flat_set<T, Compare>::size() {
+  return keys_.size();
+}
+
+template <typename T, typename Compare>
+inline size_t flat_set<T, Compare>::max_size() {
+  return keys_.max_size();
+}
+
+template <typename T, typename Compare>
+void flat_set<T, Compare>::reserve(size_type size) {
+  keys_.reserve(size);
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::key_compare flat_set<T, Compare>::key_comp()
+    const {
+  return comp_;
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::value_compare
+flat_set<T, Compare>::value_comp() const {
+  return comp_;
+}
+
+template <typename T, typename Compare>
+void flat_set<T, Compare>::clear() {
+  keys_.clear();
+}
+
+// Keys past the current maximum are appended without a search.
+template <typename T, typename Compare>
+std::pair<typename flat_set<T, Compare>::iterator, bool>
+flat_set<T, Compare>::insert(value_type key) {
+  size_type n = keys_.size();
+  if (n == 0 || comp_(keys_[n - 1], key)) {
+    keys_.push_back(std::move(key));
+    return std::pair<iterator, bool>(end() - 1, true);
+  }
+
+  size_type i = lower_index(key);
+  if (!comp_(key, keys_[i]))
+    return std::pair<iterator, bool>(begin() + i, false);
+  return std::pair<iterator, bool>(
+      keys_.insert_many(keys_.begin() + i, std::move(key)), true);
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::insert(
+    iterator hint, value_type key) {
+  if ((hint == end() || comp_(key, *hint)) &&
+      (hint == begin() || comp_(*(hint - 1), key)))
+    return keys_.insert_many(hint, std::move(key));
+  return insert(std::move(key)).first;
+}
+
+template <typename T, typename Compare>
+template <typename... Args>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::emplace_hint(
+    iterator hint, Args &&...args) {
+  value_type key(std::forward<Args>(args)...);
+  return insert(hint, std::move(key));
+}
+
+template <typename T, typename Compare>
+void flat_set<T, Compare>::erase(iterator pos) {
+  if (pos == end()) return;
+  keys_.erase(pos);
+}
+
+template <typename T, typename Compare>
+void flat_set<T, Compare>::swap(flat_set &other) {
+  keys_.swap(other.keys_);
+  std::swap(comp_, other.comp_);
+}
+
+template <typename T, typename Compare>
+void flat_set<T, Compare>::merge(flat_set &other) {
+  if (this == &other || other.empty()) return;
+
+  Vector<T> merged;
+  Vector<T> rest;
+  merged.reserve(keys_.size() + other.keys_.size());
+  iterator a = begin();
+  iterator b = other.begin();
+  while (a != end() && b != other.end()) {
+    if (comp_(*a, *b)) {
+      merged.push_back(std::move(*a++));
+    } else if (comp_(*b, *a)) {
+      merged.push_back(std::move(*b++));
+    } else {
+      merged.push_back(std::move(*a++));
+      rest.push_back(std::move(*b++));
+    }
+  }
+  for (; a != end(); ++a) merged.push_back(std::move(*a));
+  for (; b != other.end(); ++b) merged.push_back(std::move(*b));
+
+  keys_ = std::move(merged);
+  other.keys_ = std::move(rest);
+}
+
+// Sorts, then squeezes out the duplicates in place.
+template <typename T, typename Compare>
+template <typename InputIt>
+void flat_set<T, Compare>::assign_sorted(InputIt first, InputIt last) {
+  Vector<T> keys;
+  keys.insert(keys.end(), first, last);
+  if (!std::is_sorted(keys.begin(), keys.end(), comp_))
+    std::stable_sort(keys.begin(), keys.end(), comp_);
+
+  auto equivalent = [this](const_reference a, const_reference b) {
+    return !comp_(a, b);
+  };
+  keys.erase(std::unique(keys.begin(), keys.end(), equivalent), keys.end());
+  keys_ = std::move(keys);
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::find(
+    const_reference key) {
+  return find_iter(key);
+}
+
+template <typename T, typename Compare>
+bool flat_set<T, Compare>::contains(const_reference key) {
+  return find_iter(key) != end();
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::find(
+    const K &key) {
+  return find_iter(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+bool flat_set<T, Compare>::contains(const K &key) {
+  return find_iter(key) != end();
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::lower_bound(
+    const_reference key) {
+  return begin() + lower_index(key);
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::upper_bound(
+    const_reference key) {
+  return begin() + upper_index(key);
+}
+
+template <typename T, typename Compare>
+std::pair<typename flat_set<T, Compare>::iterator,
+          typename flat_set<T, Compare>::iterator>
+flat_set<T, Compare>::equal_range(const_reference key) {
+  size_type i = lower_index(key);
+  size_type j = i < keys_.size() && !comp_(key, keys_[i]) ? i + 1 : i;
+  return {begin() + i, begin() + j};
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::lower_bound(
+    const K &key) {
+  return begin() + lower_index(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::upper_bound(
+    const K &key) {
+  return begin() + upper_index(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+std::pair<typename flat_set<T, Compare>::iterator,
+          typename flat_set<T, Compare>::iterator>
+flat_set<T, Compare>::equal_range(const K &key) {
+  size_type i = lower_index(key);
+  size_type j = i < keys_.size() && !comp_(key, keys_[i]) ? i + 1 : i;
+  return {begin() + i, begin() + j};
+}
+
+template <typename T, typename Compare>
+template <typename... Args>
+Vector<std::pair<typename flat_set<T, Compare>::iterator, bool>>
+flat_set<T, Compare>::insert_many(Args &&...args) {
+  Vector<std::pair<iterator, bool>> res;
+
+  size_type count = sizeof...(Args);
+  if (count == 0) throw std::runtime_error("Error: Zero args");
+  T tmp[sizeof...(Args)] = {std::forward<Args>(args)...};
+  for (size_type i = 0; i < count; i++) {
+    res.push_back(insert(tmp[i]));
+  }
+
+  return res;
+}
+
+template <typename T, typename Compare>
+template <typename K>
+inline typename flat_set<T, Compare>::size_type
+flat_set<T, Compare>::lower_index(const K &key) {
+  return detail::branchless_lower_bound(keys_.data(), keys_.size(), key,
+                                        comp_);
+}
+
+template <typename T, typename Compare>
+template <typename K>
+inline typename flat_set<T, Compare>::size_type
+flat_set<T, Compare>::upper_index(const K &key) {
+  size_type i = lower_index(key);
+  return i < keys_.size() && !comp_(key, keys_[i]) ? i + 1 : i;
+}
+
+template <typename T, typename Compare>
+template <typename K>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::find_iter(
+    const K &key) {
+  size_type i = lower_index(key);
+  if (i < keys_.size() && !comp_(key, keys_[i])) return begin() + i;
+  return end();
+}
+
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_FLAT_SET_H
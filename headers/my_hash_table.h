@@ -0,0 +1,647 @@
+#ifndef _MY_CONTAINER_HASH_TABLE_H
+#define _MY_CONTAINER_HASH_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace my {
+
+namespace detail {
+
+// Sixteen control bytes loaded at once, matched as a bit mask in which
+// bit i stands for byte i. A control byte is either ctrl_empty or seven
+// bits of the hash of the element in a full slot.
+struct probe_group {
+  static constexpr std::size_t width = 16;
+  static constexpr std::uint8_t ctrl_empty = 0x80;
+
+#if defined(__SSE2__)
+  explicit probe_group(const std::uint8_t *ctrl)
+      : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+
+  std::uint32_t match(std::uint8_t h2) const {
+    return _mm_movemask_epi8(
+        _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(h2))));
+  }
+  // Only the empty byte has its high bit set.
+  std::uint32_t match_empty() const { return _mm_movemask_epi8(bytes); }
+
+  __m128i bytes;
+#else
+  explicit probe_group(const std::uint8_t *ctrl) {
+    std::memcpy(bytes, ctrl, width);
+  }
+
+  std::uint32_t match(std::uint8_t h2) const {
+    std::uint32_t res = 0;
+    for (std::size_t i = 0; i < width; i++) res |= (bytes[i] == h2) << i;
+    return res;
+  }
+  std::uint32_t match_empty() const {
+    std::uint32_t res = 0;
+    for (std::size_t i = 0; i < width; i++) res |= (bytes[i] >> 7) << i;
+    return res;
+  }
+
+  std::uint8_t bytes[width];
+#endif
+};
+
+}  // namespace detail
+
+// Hashes and compares the pairs stored by unordered_map by their first
+// member alone. Lookups hand in bare keys, so both also accept any key
+// type Hash and KeyEqual take.
+template <typename Key, typename T, typename Hash>
+struct pair_first_hash {
+  Hash hash;
+
+  std::size_t operator()(const std::pair<Key, T> &a) const {
+    return hash(a.first);
+  }
+  template <typename K>
+  std::size_t operator()(const K &a) const {
+    return hash(a);
+  }
+};
+
+template <typename Key, typename T, typename KeyEqual>
+struct pair_first_equal {
+  KeyEqual eq;
+
+  template <typename K>
+  bool operator()(const std::pair<Key, T> &a, const K &b) const {
+    return eq(a.first, b);
+  }
+  bool operator()(const std::pair<Key, T> &a,
+                  const std::pair<Key, T> &b) const {
+    return eq(a.first, b.first);
+  }
+};
+
+// Open addressing hash table in the style of Swiss tables: one control
+// byte per slot holds seven bits of the element's hash, and a probe
+// matches sixteen of them per SSE2 instruction, so keys are only compared
+// on a likely hit. Probing is linear, a window of sixteen slots at a time
+// starting at the key's home slot, which lets erase() shift the rest of
+// the run back into the hole instead of leaving a tombstone: lookups never
+// wade through deleted slots and the table never needs a cleanup rehash.
+//
+// Inserts may rehash and erase moves elements, so both invalidate
+// iterators.
+template <typename T, typename Hash = std::hash<T>,
+          typename KeyEqual = std::equal_to<T>>
+class hash_table {
+ public:
+  class iterator;
+
+  using value_type = T;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  // The table grows once it would be more than 7/8 full.
+  static constexpr size_type max_load_num = 7;
+  static constexpr size_type max_load_den = 8;
+
+  hash_table() = default;
+  explicit hash_table(const Hash &hash, const KeyEqual &eq = KeyEqual());
+  hash_table(const hash_table &other);
+  hash_table(hash_table &&other) noexcept;
+  ~hash_table();
+  hash_table &operator=(hash_table &&other) noexcept;
+
+  iterator begin();
+  iterator end();
+
+  bool empty();
+  size_type size();
+  size_type max_size();
+  size_type capacity();
+  float load_factor();
+  // Makes room for n elements without further rehashing.
+  void reserve(size_type n);
+
+  void clear();
+  std::pair<iterator, bool> insert(value_type value);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args);
+  void erase(iterator pos);
+  void swap(hash_table &other);
+
+  // Moves over the elements of other that this table lacks and leaves the
+  // rest in other.
+  void merge(hash_table &other);
+
+  iterator find(const_reference key);
+  bool contains(const_reference key);
+
+  // Lookups by any type that both Hash and KeyEqual accept, enabled when
+  // both are transparent.
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  bool contains(const K &key);
+
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    iterator() = default;
+    iterator(hash_table *table, size_type index);
+    reference operator*() const;
+    pointer operator->() const;
+    bool operator==(const iterator &other) const;
+    bool operator!=(const iterator &other) const;
+    iterator &operator++();
+    iterator operator++(int);
+
+   private:
+    friend class hash_table;
+
+    void skip_empty();
+
+    hash_table *table_ = nullptr;
+    size_type index_ = 0;
+  };
+
+ protected:
+  using group = detail::probe_group;
+  using ctrl_t = std::uint8_t;
+
+  static constexpr size_type npos = std::numeric_limits<size_type>::max();
+  static constexpr size_type min_capacity = group::width;
+
+  // The outcome of looking a key up before inserting it: the slot of the
+  // equivalent element if found, and the key's hash either way.
+  struct insert_position {
+    size_type index;
+    std::uint64_t hash;
+    bool found;
+  };
+
+  static std::uint64_t mix(std::uint64_t h);
+  template <typename K>
+  std::uint64_t hash_of(const K &key) const;
+  size_type home(std::uint64_t hash) const;
+  template <typename K>
+  size_type find_index(const K &key, std::uint64_t hash);
+  template <typename K>
+  insert_position find_insert_pos(const K &key);
+  size_type find_empty(std::uint64_t hash) const;
+  template <typename... Args>
+  iterator insert_at(insert_position pos, Args &&...args);
+  void set_ctrl(size_type i, ctrl_t c);
+  void grow_for(size_type n);
+  void rehash(size_type new_capacity);
+  void allocate(size_type capacity);
+  void destroy_all();
+  void deallocate();
+
+  ctrl_t *ctrl_ = nullptr;
+  value_type *slots_ = nullptr;
+  size_type capacity_ = 0;
+  size_type count_ = 0;
+  Hash hash_;
+  KeyEqual eq_;
+};
+
+template <typename T, typename Hash, typename KeyEqual>
+hash_table<T, Hash, KeyEqual>::hash_table(const Hash &hash,
+                                          const KeyEqual &eq)
+    : hash_(hash), eq_(eq) {}
+
+// Same capacity, so every element lands in the slot it had in other.
+template <typename T, typename Hash, typename KeyEqual>
+hash_table<T, Hash, KeyEqual>::hash_table(const hash_table &other)
+    : hash_(other.hash_), eq_(other.eq_) {
+  if (other.count_ == 0) return;
+  allocate(other.capacity_);
+  for (size_type i = 0; i < capacity_; i++) {
+    if (other.ctrl_[i] == group::ctrl_empty) continue;
+    try {
+      new (slots_ + i) value_type(other.slots_[i]);
+    } catch (...) {
+      destroy_all();
+      deallocate();
+      throw;
+    }
+    set_ctrl(i, other.ctrl_[i]);
+    count_++;
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+hash_table<T, Hash, KeyEqual>::hash_table(hash_table &&other) noexcept
+    : ctrl_(other.ctrl_),
+      slots_(other.slots_),
+      capacity_(other.capacity_),
+      count_(other.count_),
+      hash_(other.hash_),
+      eq_(other.eq_) {
+  other.ctrl_ = nullptr;
+  other.slots_ = nullptr;
+  other.capacity_ = other.count_ = 0;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+hash_table<T, Hash, KeyEqual>::~hash_table() {
+  destroy_all();
+  deallocate();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+hash_table<T, Hash, KeyEqual> &hash_table<T, Hash, KeyEqual>::operator=(
+    hash_table &&other) noexcept {
+  if (this != &other) {
+    clear();
+    swap(other);
+  }
+
+  return *this;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename hash_table<T, Hash, KeyEqual>::iterator
+hash_table<T, Hash, KeyEqual>::begin() {
+  iterator it(this, 0);
+  it.skip_empty();
+  return it;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename hash_table<T, Hash, KeyEqual>::iterator
+hash_table<T, Hash, KeyEqual>::end() {
+  return iterator(this, capacity_);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+inline bool hash_table<T, Hash, KeyEqual>::empty() {
+  return count_ == 0;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+inline size_t hash_table<T, Hash, KeyEqual>::size() {
+  return count_;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+inline size_t hash_table<T, Hash, KeyEqual>::max_size() {
+  return std::numeric_limits<size_type>::max() / (sizeof(value_type) + 1) /
+         max_load_den * max_load_num;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+inline size_t hash_table<T, Hash, KeyEqual>::capacity() {
+  return capacity_;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+float hash_table<T, Hash, KeyEqual>::load_factor() {
+  return capacity_ ? static_cast<float>(count_) / capacity_ : 0.0f;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::reserve(size_type n) {
+  grow_for(n);
+}
+
+// Keeps the slot arrays for the elements to come.
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::clear() {
+  destroy_all();
+  if (ctrl_)
+    std::memset(ctrl_, group::ctrl_empty, capacity_ + group::width - 1);
+  count_ = 0;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+std::pair<typename hash_table<T, Hash, KeyEqual>::iterator, bool>
+hash_table<T, Hash, KeyEqual>::insert(value_type value) {
+  insert_position pos = find_insert_pos(value);
+
+  if (pos.found)
+    return std::pair<iterator, bool>(iterator(this, pos.index), false);
+  return std::pair<iterator, bool>(insert_at(pos, std::move(value)), true);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+std::pair<typename hash_table<T, Hash, KeyEqual>::iterator, bool>
+hash_table<T, Hash, KeyEqual>::emplace(Args &&...args) {
+  value_type value(std::forward<Args>(args)...);
+  return insert(std::move(value));
+}
+
+// Backward shift deletion: every later element of the run that may sit
+// at or before the hole (its home is not inside the stretch between the
+// hole and itself) moves into it, leaving a new hole behind, until the run
+// ends at an empty slot.
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::erase(iterator pos) {
+  if (pos.table_ != this || pos.index_ >= capacity_) return;
+  size_type mask = capacity_ - 1;
+  size_type hole = pos.index_;
+  slots_[hole].~value_type();
+
+  for (size_type i = (hole + 1) & mask; ctrl_[i] != group::ctrl_empty;
+       i = (i + 1) & mask) {
+    size_type distance = (i - home(hash_of(slots_[i]))) & mask;
+    if (distance >= ((i - hole) & mask)) {
+      new (slots_ + hole) value_type(std::move(slots_[i]));
+      slots_[i].~value_type();
+      set_ctrl(hole, ctrl_[i]);
+      hole = i;
+    }
+  }
+  set_ctrl(hole, group::ctrl_empty);
+  count_--;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::swap(hash_table &other) {
+  std::swap(ctrl_, other.ctrl_);
+  std::swap(slots_, other.slots_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(count_, other.count_);
+  std::swap(hash_, other.hash_);
+  std::swap(eq_, other.eq_);
+}
+
+// The elements this table already has are set aside and put back into
+// other once it has been emptied, since erasing from other while walking
+// it would shift elements past the iterator.
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::merge(hash_table &other) {
+  if (this == &other || other.count_ == 0) return;
+
+  hash_table rest(other.hash_, other.eq_);
+  grow_for(count_ + other.count_);
+  for (iterator it = other.begin(); it != other.end(); ++it) {
+    insert_position pos = find_insert_pos(*it);
+    if (pos.found)
+      rest.insert(std::move(*it));
+    else
+      insert_at(pos, std::move(*it));
+  }
+  other.swap(rest);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename hash_table<T, Hash, KeyEqual>::iterator
+hash_table<T, Hash, KeyEqual>::find(const_reference key) {
+  size_type i = find_index(key, hash_of(key));
+  return i == npos ? end() : iterator(this, i);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool hash_table<T, Hash, KeyEqual>::contains(const_reference key) {
+  return find_index(key, hash_of(key)) != npos;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K, typename H, typename E, typename, typename>
+typename hash_table<T, Hash, KeyEqual>::iterator
+hash_table<T, Hash, KeyEqual>::find(const K &key) {
+  size_type i = find_index(key, hash_of(key));
+  return i == npos ? end() : iterator(this, i);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K, typename H, typename E, typename, typename>
+bool hash_table<T, Hash, KeyEqual>::contains(const K &key) {
+  return find_index(key, hash_of(key)) != npos;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+hash_table<T, Hash, KeyEqual>::iterator::iterator(hash_table *table,
+                                                  size_type index)
+    : table_(table), index_(index) {}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename hash_table<T, Hash, KeyEqual>::iterator::reference
+hash_table<T, Hash, KeyEqual>::iterator::operator*() const {
+  return table_->slots_[index_];
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename hash_table<T, Hash, KeyEqual>::iterator::pointer
+hash_table<T, Hash, KeyEqual>::iterator::operator->() const {
+  return table_->slots_ + index_;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+inline bool hash_table<T, Hash, KeyEqual>::iterator::operator==(
+    const iterator &other) const {
+  return index_ == other.index_ && table_ == other.table_;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+inline bool hash_table<T, Hash, KeyEqual>::iterator::operator!=(
+    const iterator &other) const {
+  return !(*this == other);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename hash_table<T, Hash, KeyEqual>::iterator &
+hash_table<T, Hash, KeyEqual>::iterator::operator++() {
+  index_++;
+  skip_empty();
+  return *this;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename hash_table<T, Hash, KeyEqual>::iterator
+hash_table<T, Hash, KeyEqual>::iterator::operator++(int) {
+  iterator tmp = *this;
+  ++*this;
+  return tmp;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::iterator::skip_empty() {
+  while (index_ < table_->capacity_ &&
+         table_->ctrl_[index_] == group::ctrl_empty)
+    index_++;
+}
+
+// std::hash is the identity for integers, so the hash is scrambled before
+// its low bits pick the home slot and its top bits the control byte.
+template <typename T, typename Hash, typename KeyEqual>
+inline std::uint64_t hash_table<T, Hash, KeyEqual>::mix(std::uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K>
+inline std::uint64_t hash_table<T, Hash, KeyEqual>::hash_of(
+    const K &key) const {
+  return mix(hash_(key));
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+inline typename hash_table<T, Hash, KeyEqual>::size_type
+hash_table<T, Hash, KeyEqual>::home(std::uint64_t hash) const {
+  return static_cast<size_type>(hash) & (capacity_ - 1);
+}
+
+// A key sits between its home slot and the first empty slot after it, so
+// the probe stops at the first window that has an empty byte.
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K>
+typename hash_table<T, Hash, KeyEqual>::size_type
+hash_table<T, Hash, KeyEqual>::find_index(const K &key,
+                                          std::uint64_t hash) {
+  if (count_ == 0) return npos;
+  ctrl_t h2 = hash >> 57;
+  size_type mask = capacity_ - 1;
+
+  for (size_type pos = home(hash);; pos = (pos + group::width) & mask) {
+    group g(ctrl_ + pos);
+    for (std::uint32_t m = g.match(h2); m; m &= m - 1) {
+      size_type i = (pos + __builtin_ctz(m)) & mask;
+      if (eq_(slots_[i], key)) return i;
+    }
+    if (g.match_empty()) return npos;
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K>
+typename hash_table<T, Hash, KeyEqual>::insert_position
+hash_table<T, Hash, KeyEqual>::find_insert_pos(const K &key) {
+  std::uint64_t hash = hash_of(key);
+  size_type i = find_index(key, hash);
+  return {i, hash, i != npos};
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename hash_table<T, Hash, KeyEqual>::size_type
+hash_table<T, Hash, KeyEqual>::find_empty(std::uint64_t hash) const {
+  size_type mask = capacity_ - 1;
+
+  for (size_type pos = home(hash);; pos = (pos + group::width) & mask) {
+    std::uint32_t m = group(ctrl_ + pos).match_empty();
+    if (m) return (pos + __builtin_ctz(m)) & mask;
+  }
+}
+
+// The arguments may refer to an element of this table, so when the table
+// has to grow the element is built before the rehash moves it.
+template <typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+typename hash_table<T, Hash, KeyEqual>::iterator
+hash_table<T, Hash, KeyEqual>::insert_at(insert_position pos,
+                                         Args &&...args) {
+  size_type i;
+  if ((count_ + 1) * max_load_den > capacity_ * max_load_num) {
+    value_type value(std::forward<Args>(args)...);
+    grow_for(count_ + 1);
+    i = find_empty(pos.hash);
+    new (slots_ + i) value_type(std::move(value));
+  } else {
+    i = find_empty(pos.hash);
+    new (slots_ + i) value_type(std::forward<Args>(args)...);
+  }
+  set_ctrl(i, pos.hash >> 57);
+  count_++;
+  return iterator(this, i);
+}
+
+// The first width - 1 control bytes are mirrored past the end, so that a
+// window starting near the end reads on from the start of the table.
+template <typename T, typename Hash, typename KeyEqual>
+inline void hash_table<T, Hash, KeyEqual>::set_ctrl(size_type i, ctrl_t c) {
+  ctrl_[i] = c;
+  if (i < group::width - 1) ctrl_[capacity_ + i] = c;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::grow_for(size_type n) {
+  if (n * max_load_den <= capacity_ * max_load_num) return;
+
+  size_type capacity = capacity_ ? capacity_ : min_capacity;
+  while (n * max_load_den > capacity * max_load_num) capacity *= 2;
+  rehash(capacity);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::rehash(size_type new_capacity) {
+  ctrl_t *old_ctrl = ctrl_;
+  value_type *old_slots = slots_;
+  size_type old_capacity = capacity_;
+
+  allocate(new_capacity);
+  for (size_type i = 0; i < old_capacity; i++) {
+    if (old_ctrl[i] == group::ctrl_empty) continue;
+    std::uint64_t hash = hash_of(old_slots[i]);
+    size_type j = find_empty(hash);
+    new (slots_ + j) value_type(std::move(old_slots[i]));
+    old_slots[i].~value_type();
+    set_ctrl(j, hash >> 57);
+  }
+
+  std::allocator<value_type>().deallocate(old_slots, old_capacity);
+  delete[] old_ctrl;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::allocate(size_type capacity) {
+  value_type *slots = std::allocator<value_type>().allocate(capacity);
+  try {
+    ctrl_ = new ctrl_t[capacity + group::width - 1];
+  } catch (...) {
+    std::allocator<value_type>().deallocate(slots, capacity);
+    throw;
+  }
+  slots_ = slots;
+  capacity_ = capacity;
+  std::memset(ctrl_, group::ctrl_empty, capacity + group::width - 1);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::destroy_all() {
+  if constexpr (!std::is_trivially_destructible_v<value_type>) {
+    for (size_type i = 0; i < capacity_; i++)
+      if (ctrl_[i] != group::ctrl_empty) slots_[i].~value_type();
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void hash_table<T, Hash, KeyEqual>::deallocate() {
+  if (slots_) std::allocator<value_type>().deallocate(slots_, capacity_);
+  delete[] ctrl_;
+  ctrl_ = nullptr;
+  slots_ = nullptr;
+  capacity_ = 0;
+}
+
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_HASH_TABLE_H
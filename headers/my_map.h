@@ -1,35 +1,81 @@
 #ifndef _MY_CONTAINER_MAP_H
 #define _MY_CONTAINER_MAP_H
 
+#include <tuple>
+
 #include "my_rbtree.h"
 #include "my_vector.h"
 
 namespace my {
 
-template <typename Key, typename T>
-class map : public rb_tree<std::pair<Key, T>> {
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class map : public rb_tree<std::pair<Key, T>,
+                           pair_first_compare<Key, T, Compare>> {
+  using tree_type =
+      rb_tree<std::pair<Key, T>, pair_first_compare<Key, T, Compare>>;
+
  public:
   using key_type = Key;
   using mapped_type = T;
+  using key_compare = Compare;
   using value_type = std::pair<key_type, mapped_type>;
   using reference = value_type &;
   using const_reference = const value_type &;
-  using iterator = typename rb_tree<value_type>::iterator;
-  using const_iterator = typename rb_tree<value_type>::const_iterator;
+  using iterator = typename tree_type::iterator;
+  using const_iterator = typename tree_type::const_iterator;
+  using node_type = typename tree_type::node_type;
+  using insert_return_type = typename tree_type::insert_return_type;
   using size_type = size_t;
 
-  map() : rb_tree<value_type>::rb_tree(){};
+  map() : tree_type(){};
+  explicit map(const Compare &comp)
+      : tree_type(pair_first_compare<Key, T, Compare>{comp}){};
   map(std::initializer_list<value_type> const &items);
-  map(const map &m) : rb_tree<value_type>::rb_tree(m){};
-  map(map &&m) noexcept : rb_tree<value_type>::rb_tree(std::move(m)){};
+  map(const map &m) : tree_type(m){};
+  map(map &&m) noexcept : tree_type(std::move(m)){};
+
+  map &operator=(map &&m) noexcept = default;
+
+  template <typename InputIt>
+  static map from_sorted(InputIt first, InputIt last,
+                         const Compare &comp = Compare());
+
+  key_compare key_comp() const;
 
   T &at(const Key &key);
+  // A missing key is inserted with a value-initialised T by the same
+  // descent that looks it up.
   T &operator[](const Key &key);
+  T &operator[](Key &&key);
 
   std::pair<iterator, bool> insert(const value_type &value);
+  std::pair<iterator, bool> insert(value_type &&value);
   std::pair<iterator, bool> insert(const Key &key, const T &obj);
-  std::pair<iterator, bool> insert_or_assign(const Key &key, const T &obj);
-  void erase(iterator pos);
+  iterator insert(iterator hint, const value_type &value);
+  insert_return_type insert(node_type &&nh);
+  template <typename InputIt,
+            typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+  void insert(InputIt first, InputIt last);
+  template <typename InputIt, typename OutputIt,
+            typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+  OutputIt insert(InputIt first, InputIt last, OutputIt out);
+
+  // One descent each. try_emplace builds the value from args only when key
+  // is missing; insert_or_assign otherwise assigns obj to the value found.
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args);
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args);
+  // The (key, obj) and value_type forms look the key up before building a
+  // node, so a duplicate costs no allocation; other forms go to the tree.
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const Key &key, M &&obj);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(Key &&key, M &&obj);
+  node_type extract(iterator pos);
+  node_type extract(const Key &key);
 
   bool contains(const Key &key);
 
@@ -37,221 +83,308 @@ class map : public rb_tree<std::pair<Key, T>> {
   Vector<std::pair<iterator, bool>> insert_many(Args &&...args);
 
   iterator find(const Key &key);
+  iterator lower_bound(const Key &key);
+  iterator upper_bound(const Key &key);
+  std::pair<iterator, iterator> equal_range(const Key &key);
+
+  // Heterogeneous lookups, e.g. a std::string keyed map searched with a
+  // std::string_view, when Compare is transparent.
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key);
 
  private:
-  typename rb_tree<value_type>::node *find(
-      typename rb_tree<value_type>::node *root, const Key &key);
-  void operator_eq(typename map<Key, T>::node *&nd1,
-                   typename map<Key, T>::node *&nd2);
-  void swap_pairs(typename map<Key, T>::node *&nd1,
-                  typename map<Key, T>::node *&nd2);
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_key(K &&key, Args &&...args);
+  template <typename K, typename M>
+  std::pair<iterator, bool> emplace_key(K &&key, M &&obj);
+  template <typename K, typename M>
+  std::pair<iterator, bool> assign_key(K &&key, M &&obj);
 };
 
-template <typename Key, typename T>
-map<Key, T>::map(const std::initializer_list<std::pair<Key, T>> &items) {
-  for (const std::pair<const Key, T> item : items)
-    insert_or_assign(item.first, item.second);
+// A repeated key keeps the last value, as if the items were assigned one
+// after the other.
+template <typename Key, typename T, typename Compare>
+map<Key, T, Compare>::map(const std::initializer_list<value_type> &items) {
+  Vector<value_type> buf;
+  buf.insert(buf.end(), items.begin(), items.end());
+  this->assign_buffer(buf, true);
 }
 
-template <typename Key, typename T>
-T &map<Key, T>::at(const Key &key) {
-  typename map<Key, T>::node *nd = find(this->root, key);
+template <typename Key, typename T, typename Compare>
+template <typename InputIt>
+map<Key, T, Compare> map<Key, T, Compare>::from_sorted(InputIt first,
+                                                       InputIt last,
+                                                       const Compare &comp) {
+  map res(comp);
+  res.assign_sorted(first, last);
+  return res;
+}
+
+template <typename Key, typename T, typename Compare>
+typename map<Key, T, Compare>::key_compare map<Key, T, Compare>::key_comp()
+    const {
+  return this->comp_.comp;
+}
+
+template <typename Key, typename T, typename Compare>
+T &map<Key, T, Compare>::at(const Key &key) {
+  typename map::node *nd = this->find_node(key);
   if (nd == nullptr) throw std::runtime_error("Error: No such key");
   return nd->key.second;
 }
 
-template <typename Key, typename T>
-T &map<Key, T>::operator[](const Key &key) {
-  return at(key);
-}
-
-template <typename Key, typename T>
-typename std::pair<typename map<Key, T>::iterator, bool> map<Key, T>::insert(
-    const std::pair<Key, T> &value) {
-  typename map<Key, T>::node *new_node;
-  typename map<Key, T>::node *cur = this->root;
-  typename map<Key, T>::node *prev = nullptr;
-  bool stop = false;
-  bool res = false;
-  iterator it;
-
-  while (cur && stop == false) {
-    prev = cur;
-    if (value.first > cur->key.first)
-      cur = cur->right;
-    else if (value.first < cur->key.first)
-      cur = cur->left;
-    else
-      stop = true;
-  }
+template <typename Key, typename T, typename Compare>
+T &map<Key, T, Compare>::operator[](const Key &key) {
+  return (*try_emplace_key(key).first).second;
+}
 
-  if (!stop) {
-    new_node =
-        new typename map<Key, T>::node(value, prev, rb_tree<value_type>::RED);
-    rb_tree<value_type>::count_++;
-
-    if (prev) {
-      if (new_node->key > prev->key)
-        prev->right = new_node;
-      else
-        prev->left = new_node;
-    } else
-      this->root = new_node;
-    it = rb_tree<value_type>::balance_on_insert(new_node);
-    res = true;
-  }
+template <typename Key, typename T, typename Compare>
+T &map<Key, T, Compare>::operator[](Key &&key) {
+  return (*try_emplace_key(std::move(key)).first).second;
+}
 
-  return std::pair<iterator, bool>(it, res);
-}
-
-template <typename Key, typename T>
-typename std::pair<typename map<Key, T>::iterator, bool> map<Key, T>::insert(
-    const Key &key, const T &obj) {
-  return insert(std::pair(key, obj));
-}
-
-template <typename Key, typename T>
-typename std::pair<typename map<Key, T>::iterator, bool>
-map<Key, T>::insert_or_assign(const Key &key, const T &obj) {
-  typename map<Key, T>::node *new_node;
-  typename map<Key, T>::node *cur = this->root;
-  typename map<Key, T>::node *prev = nullptr;
-  bool stop = false;
-  bool res = false;
-  iterator it;
-
-  while (cur && stop == false) {
-    prev = cur;
-    if (key > cur->key.first)
-      cur = cur->right;
-    else if (key < cur->key.first)
-      cur = cur->left;
-    else if (key == cur->key.first) {
-      cur->key.second = obj;
-      stop = true;
-    } else
-      stop = true;
-  }
+template <typename Key, typename T, typename Compare>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::insert(const value_type &value) {
+  typename map::insert_position pos = this->find_insert_pos(value.first);
 
-  if (!stop) {
-    new_node = new
-        typename map<Key, T>::node({key, obj}, prev, rb_tree<value_type>::RED);
-    rb_tree<value_type>::count_++;
-
-    if (prev) {
-      if (new_node->key > prev->key)
-        prev->right = new_node;
-      else
-        prev->left = new_node;
-    } else
-      this->root = new_node;
-    it = rb_tree<value_type>::balance_on_insert(new_node);
-    res = true;
-  }
+  if (pos.existing) return std::pair<iterator, bool>(pos.existing, false);
+  return std::pair<iterator, bool>(this->insert_at(pos, value), true);
+}
 
-  return std::pair<iterator, bool>(it, res);
-}
-
-template <typename Key, typename T>
-void map<Key, T>::erase(iterator pos) {
-  typename map<Key, T>::node *replace, *delete_node = this->get_iter_node(pos),
-                                       *tmp = nullptr;
-  if (!delete_node)
-    return;
-  else if (delete_node == this->root && !this->root->left &&
-           !this->root->right) {
-    delete delete_node;
-    this->root = nullptr;
-    rb_tree<value_type>::count_--;
-    return;
-  }
-  if (delete_node->left && delete_node->right)  // case : two children
-  {
-    replace = delete_node->right;
-    while (replace->left) replace = replace->left;
-    swap_pairs(delete_node, replace);
-  } else
-    replace = delete_node;
-  if (replace->right && !replace->left)  // case right child, no left child
-  {
-    operator_eq(replace, replace->right);
-    tmp = replace->right;
-    replace->right = nullptr;
-    delete tmp;
-  } else if (replace->left &&
-             !replace->right)  // case left child, no right child
-  {
-    operator_eq(replace, replace->left);
-    tmp = replace->left;
-    replace->left = nullptr;
-    delete tmp;
-  } else  // case no children
-  {
-    typename map<Key, T>::node *tmp_parent;
-    typename rb_tree<value_type>::node_colors color = replace->color;
-    tmp = replace;
-    if (replace != this->root) {
-      if (replace->parent->left == replace) replace->parent->left = nullptr;
-      if (replace->parent->right == replace) replace->parent->right = nullptr;
-    }
-    tmp_parent = replace->parent;
-
-    delete tmp;
-    if (color == rb_tree<value_type>::BLACK)
-      this->balance_on_delete(tmp_parent, nullptr);
+template <typename Key, typename T, typename Compare>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::insert(value_type &&value) {
+  return try_emplace_key(std::move(value.first), std::move(value.second));
+}
+
+template <typename Key, typename T, typename Compare>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::insert(const Key &key, const T &obj) {
+  return try_emplace_key(key, obj);
+}
+
+template <typename Key, typename T, typename Compare>
+typename map<Key, T, Compare>::iterator map<Key, T, Compare>::insert(
+    iterator hint, const value_type &value) {
+  typename map::insert_position pos =
+      this->find_hint_pos(this->get_iter_node(hint), value.first);
+
+  if (pos.existing) return iterator(pos.existing);
+  return this->insert_at(pos, value);
+}
+
+template <typename Key, typename T, typename Compare>
+typename map<Key, T, Compare>::insert_return_type map<Key, T, Compare>::insert(
+    node_type &&nh) {
+  return tree_type::insert(std::move(nh));
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename InputIt, typename>
+void map<Key, T, Compare>::insert(InputIt first, InputIt last) {
+  tree_type::insert(first, last);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename InputIt, typename OutputIt, typename>
+OutputIt map<Key, T, Compare>::insert(InputIt first, InputIt last,
+                                      OutputIt out) {
+  return tree_type::insert(first, last, out);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::try_emplace(const Key &key, Args &&...args) {
+  return try_emplace_key(key, std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::try_emplace(Key &&key, Args &&...args) {
+  return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::emplace(Args &&...args) {
+  if constexpr (sizeof...(Args) == 2) {
+    return emplace_key(std::forward<Args>(args)...);
+  } else if constexpr (sizeof...(Args) == 1 &&
+                       (std::is_same_v<std::decay_t<Args>, value_type> &&
+                        ...)) {
+    return insert(std::forward<Args>(args)...);
+  } else {
+    return tree_type::emplace(std::forward<Args>(args)...);
   }
-  rb_tree<value_type>::count_--;
 }
 
-template <typename Key, typename T>
-bool map<Key, T>::contains(const Key &key) {
-  return find(key) != nullptr;
+template <typename Key, typename T, typename Compare>
+template <typename M>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::insert_or_assign(const Key &key, M &&obj) {
+  return assign_key(key, std::forward<M>(obj));
 }
 
-template <typename Key, typename T>
-typename map<Key, T>::iterator map<Key, T>::find(const Key &key) {
-  return iterator(find(this->root, key));
+template <typename Key, typename T, typename Compare>
+template <typename M>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::insert_or_assign(Key &&key, M &&obj) {
+  return assign_key(std::move(key), std::forward<M>(obj));
 }
 
-template <typename Key, typename T>
-typename rb_tree<std::pair<Key, T>>::node *map<Key, T>::find(
-    typename rb_tree<std::pair<Key, T>>::node *root, const Key &key) {
-  if (root == nullptr) return nullptr;
-  typename map<Key, T>::node *res;
-  if (root->key.first == key)
-    res = root;
-  else if (root->key.first < key)
-    res = find(root->right, key);
-  else if (root->key.first > key)
-    res = find(root->left, key);
-  return res;
+template <typename Key, typename T, typename Compare>
+typename map<Key, T, Compare>::node_type map<Key, T, Compare>::extract(
+    iterator pos) {
+  return tree_type::extract(pos);
+}
+
+template <typename Key, typename T, typename Compare>
+typename map<Key, T, Compare>::node_type map<Key, T, Compare>::extract(
+    const Key &key) {
+  typename map::node *nd = this->find_node(key);
+  return nd ? tree_type::extract(iterator(nd)) : node_type();
+}
+
+template <typename Key, typename T, typename Compare>
+bool map<Key, T, Compare>::contains(const Key &key) {
+  return this->find_node(key) != nullptr;
+}
+
+template <typename Key, typename T, typename Compare>
+typename map<Key, T, Compare>::iterator map<Key, T, Compare>::find(
+    const Key &key) {
+  typename map::node *res = this->find_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+typename map<Key, T, Compare>::iterator map<Key, T, Compare>::find(
+    const K &key) {
+  typename map::node *res = this->find_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+bool map<Key, T, Compare>::contains(const K &key) {
+  return this->find_node(key) != nullptr;
+}
+
+template <typename Key, typename T, typename Compare>
+typename map<Key, T, Compare>::iterator map<Key, T, Compare>::lower_bound(
+    const Key &key) {
+  typename map::node *res = this->lower_bound_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename T, typename Compare>
+typename map<Key, T, Compare>::iterator map<Key, T, Compare>::upper_bound(
+    const Key &key) {
+  typename map::node *res = this->upper_bound_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename T, typename Compare>
+std::pair<typename map<Key, T, Compare>::iterator,
+          typename map<Key, T, Compare>::iterator>
+map<Key, T, Compare>::equal_range(const Key &key) {
+  return this->equal_range_of(key);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+typename map<Key, T, Compare>::iterator map<Key, T, Compare>::lower_bound(
+    const K &key) {
+  typename map::node *res = this->lower_bound_node(key);
+  return res ? iterator(res) : this->end();
 }
 
-template <typename Key, typename T>
-void map<Key, T>::operator_eq(typename map<Key, T>::node *&nd1,
-                              typename map<Key, T>::node *&nd2) {
-  nd1->key.first = nd2->key.first;
-  nd1->key.second = nd2->key.second;
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+typename map<Key, T, Compare>::iterator map<Key, T, Compare>::upper_bound(
+    const K &key) {
+  typename map::node *res = this->upper_bound_node(key);
+  return res ? iterator(res) : this->end();
 }
 
-template <typename Key, typename T>
-void map<Key, T>::swap_pairs(typename map<Key, T>::node *&nd1,
-                             typename map<Key, T>::node *&nd2) {
-  std::swap(nd1->key.first, nd2->key.first);
-  std::swap(nd1->key.second, nd2->key.second);
+template <typename Key, typename T, typename Compare>
+template <typename K, typename C, typename>
+std::pair<typename map<Key, T, Compare>::iterator,
+          typename map<Key, T, Compare>::iterator>
+map<Key, T, Compare>::equal_range(const K &key) {
+  return this->equal_range_of(key);
 }
 
-template <typename Key, typename T>
+template <typename Key, typename T, typename Compare>
 template <typename... Args>
-Vector<std::pair<typename map<Key, T>::iterator, bool>>
-map<Key, T>::insert_many(Args &&...args) {
+Vector<std::pair<typename map<Key, T, Compare>::iterator, bool>>
+map<Key, T, Compare>::insert_many(Args &&...args) {
   Vector<std::pair<iterator, bool>> res;
+  res.reserve(sizeof...(Args));
 
   for (const auto &arg : {args...}) res.push_back(insert(arg));
 
   return res;
 }
 
+template <typename Key, typename T, typename Compare>
+template <typename K, typename... Args>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::try_emplace_key(K &&key, Args &&...args) {
+  typename map::insert_position pos = this->find_insert_pos(key);
+
+  if (pos.existing) return std::pair<iterator, bool>(pos.existing, false);
+  return std::pair<iterator, bool>(
+      this->insert_at(pos, std::piecewise_construct,
+                      std::forward_as_tuple(std::forward<K>(key)),
+                      std::forward_as_tuple(std::forward<Args>(args)...)),
+      true);
+}
+
+// A key of another type is converted once up front rather than on every
+// comparison of the descent.
+template <typename Key, typename T, typename Compare>
+template <typename K, typename M>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::emplace_key(K &&key, M &&obj) {
+  if constexpr (std::is_same_v<std::decay_t<K>, Key>)
+    return try_emplace_key(std::forward<K>(key), std::forward<M>(obj));
+  else
+    return try_emplace_key(Key(std::forward<K>(key)), std::forward<M>(obj));
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename K, typename M>
+typename std::pair<typename map<Key, T, Compare>::iterator, bool>
+map<Key, T, Compare>::assign_key(K &&key, M &&obj) {
+  typename map::insert_position pos = this->find_insert_pos(key);
+
+  if (pos.existing) {
+    pos.existing->key.second = std::forward<M>(obj);
+    return std::pair<iterator, bool>(pos.existing, false);
+  }
+  return std::pair<iterator, bool>(
+      this->insert_at(pos, std::forward<K>(key), std::forward<M>(obj)), true);
+}
+
 }  // namespace my
 
-#endif
\ No newline at end of file
+#endif
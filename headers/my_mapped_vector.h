@@ -0,0 +1,447 @@
+#ifndef _MY_CONTAINER_MAPPED_VECTOR_H
+#define _MY_CONTAINER_MAPPED_VECTOR_H
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+#include "my_vector.h"
+
+namespace my {
+
+// Vector for very large buffers of trivially copyable elements. Storage is
+// a private anonymous mapping (or a shared mapping of a file) that grows
+// with mremap, so reallocation never copies the elements and never needs
+// the old and the new buffer at once. A file-backed vector maps the file
+// shared. sync() and destruction trim the file to size() elements, sync()
+// also flushing it, so reopening the path restores the contents as of the
+// last of them. sync() keeps the capacity; the file is lengthened again
+// only once the vector grows past the trimmed size.
+template <typename T>
+class mapped_vector {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "mapped_vector needs trivially copyable elements");
+
+ public:
+  using value_type = T;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = T *;
+  using const_iterator = const T *;
+  using size_type = size_t;
+
+  enum class advice { normal, sequential, random, will_need, huge_pages };
+
+  mapped_vector();
+  explicit mapped_vector(const std::string &path);
+  mapped_vector(std::initializer_list<value_type> const &items);
+  mapped_vector(const mapped_vector &v) = delete;
+  mapped_vector(mapped_vector &&v) noexcept;
+
+  ~mapped_vector();
+
+  mapped_vector &operator=(mapped_vector &&v) noexcept;
+
+  reference at(size_type pos);
+  reference operator[](size_type pos);
+  const_reference front();
+  const_reference back();
+  T *data();
+
+  iterator begin();
+  iterator end();
+
+  bool empty();
+  size_type size();
+  size_type max_size();
+  void reserve(size_type size);
+  size_type capacity();
+  void shrink_to_fit();
+
+  void clear();
+  iterator insert(iterator pos, const_reference value);
+
+  template <typename... Args>
+  void insert_many_back(Args &&...args);
+
+  void erase(iterator pos);
+  void push_back(const_reference value);
+  void pop_back();
+  void swap(mapped_vector &other);
+
+  void advise(advice hint);
+  void sync();
+  bool file_backed();
+
+ private:
+  static size_type page_size();
+  static size_type bytes_for(size_type n);
+  static void throw_errno();
+  void apply_advice();
+  void remap(size_type new_cap);
+  void make_room(size_type new_len);
+  void release();
+
+  size_type len = 0;
+  size_type cap = 0;
+  // Elements the file is long enough for: cap, or less after sync()
+  // trimmed it. Always cap for an anonymous mapping.
+  size_type file_len = 0;
+  T *values = nullptr;
+  int fd = -1;
+  advice hint_ = advice::normal;
+};
+
+template <typename T>
+mapped_vector<T>::mapped_vector() {}
+
+template <typename T>
+mapped_vector<T>::mapped_vector(const std::string &path) {
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) throw_errno();
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::system_error(err, std::generic_category());
+  }
+  size_type stored = static_cast<size_type>(st.st_size) / sizeof(T);
+  try {
+    reserve(stored);
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  len = stored;
+}
+
+template <typename T>
+mapped_vector<T>::mapped_vector(
+    std::initializer_list<value_type> const &items) {
+  reserve(items.size());
+  std::copy(items.begin(), items.end(), values);
+  len = items.size();
+}
+
+template <typename T>
+mapped_vector<T>::mapped_vector(mapped_vector &&v) noexcept
+    : len(v.len),
+      cap(v.cap),
+      file_len(v.file_len),
+      values(v.values),
+      fd(v.fd),
+      hint_(v.hint_) {
+  v.len = 0;
+  v.cap = 0;
+  v.file_len = 0;
+  v.values = nullptr;
+  v.fd = -1;
+}
+
+template <typename T>
+mapped_vector<T>::~mapped_vector() {
+  release();
+}
+
+template <typename T>
+mapped_vector<T> &mapped_vector<T>::operator=(mapped_vector &&v) noexcept {
+  if (this != &v) {
+    release();
+    len = v.len;
+    cap = v.cap;
+    file_len = v.file_len;
+    values = v.values;
+    fd = v.fd;
+    hint_ = v.hint_;
+
+    v.len = 0;
+    v.cap = 0;
+    v.file_len = 0;
+    v.values = nullptr;
+    v.fd = -1;
+  }
+  return *this;
+}
+
+template <typename T>
+typename mapped_vector<T>::reference mapped_vector<T>::at(size_type pos) {
+  if (pos >= len) {
+    throw std::out_of_range("pos >= this->size()");
+  }
+  return values[pos];
+}
+
+template <typename T>
+typename mapped_vector<T>::reference mapped_vector<T>::operator[](
+    size_type pos) {
+  MY_CONTAINERS_ASSERT(pos < len, "mapped_vector index out of range");
+  return values[pos];
+}
+
+template <typename T>
+typename mapped_vector<T>::const_reference mapped_vector<T>::front() {
+  MY_CONTAINERS_ASSERT(len > 0, "front() on an empty mapped_vector");
+  return values[0];
+}
+
+template <typename T>
+typename mapped_vector<T>::const_reference mapped_vector<T>::back() {
+  MY_CONTAINERS_ASSERT(len > 0, "back() on an empty mapped_vector");
+  return values[len - 1];
+}
+
+template <typename T>
+T *mapped_vector<T>::data() {
+  return values;
+}
+
+template <typename T>
+typename mapped_vector<T>::iterator mapped_vector<T>::begin() {
+  return values;
+}
+
+template <typename T>
+typename mapped_vector<T>::iterator mapped_vector<T>::end() {
+  return values + len;
+}
+
+template <typename T>
+bool mapped_vector<T>::empty() {
+  return len == 0;
+}
+
+template <typename T>
+typename mapped_vector<T>::size_type mapped_vector<T>::size() {
+  return len;
+}
+
+template <typename T>
+typename mapped_vector<T>::size_type mapped_vector<T>::max_size() {
+  return std::numeric_limits<std::ptrdiff_t>::max() / sizeof(value_type);
+}
+
+template <typename T>
+void mapped_vector<T>::reserve(size_type size) {
+  if (size <= cap) return;
+  if (size > max_size()) throw std::length_error("size > this->max_size()");
+  remap(size);
+}
+
+template <typename T>
+typename mapped_vector<T>::size_type mapped_vector<T>::capacity() {
+  return cap;
+}
+
+template <typename T>
+void mapped_vector<T>::shrink_to_fit() {
+  if (bytes_for(len) < bytes_for(cap)) remap(len);
+}
+
+template <typename T>
+void mapped_vector<T>::clear() {
+  len = 0;
+}
+
+template <typename T>
+typename mapped_vector<T>::iterator mapped_vector<T>::insert(
+    iterator pos, const_reference value) {
+  size_type index = pos - begin();
+  // value may live in the mapping that is about to move
+  value_type tmp = value;
+
+  make_room(len + 1);
+  std::memmove(static_cast<void *>(values + index + 1),
+               static_cast<const void *>(values + index),
+               (len - index) * sizeof(T));
+  values[index] = tmp;
+  ++len;
+  return begin() + index;
+}
+
+template <typename T>
+template <typename... Args>
+void mapped_vector<T>::insert_many_back(Args &&...args) {
+  make_room(len + sizeof...(Args));
+  ((values[len++] = T(std::forward<Args>(args))), ...);
+}
+
+template <typename T>
+void mapped_vector<T>::erase(iterator pos) {
+  std::memmove(static_cast<void *>(pos), static_cast<const void *>(pos + 1),
+               (end() - pos - 1) * sizeof(T));
+  --len;
+}
+
+template <typename T>
+void mapped_vector<T>::push_back(const_reference value) {
+  if (len == file_len) {
+    value_type tmp = value;
+    make_room(len + 1);
+    values[len++] = tmp;
+  } else {
+    values[len++] = value;
+  }
+}
+
+template <typename T>
+void mapped_vector<T>::pop_back() {
+  if (len > 0) {
+    --len;
+  }
+}
+
+template <typename T>
+void mapped_vector<T>::swap(mapped_vector &other) {
+  std::swap(len, other.len);
+  std::swap(cap, other.cap);
+  std::swap(file_len, other.file_len);
+  std::swap(values, other.values);
+  std::swap(fd, other.fd);
+  std::swap(hint_, other.hint_);
+}
+
+template <typename T>
+void mapped_vector<T>::advise(advice hint) {
+  hint_ = hint;
+  apply_advice();
+}
+
+// Trims the file so that its length, which the constructor reads the size
+// from, is right even if the vector is never destroyed. The mapping and
+// the capacity stay; make_room() lengthens the file again when needed.
+template <typename T>
+void mapped_vector<T>::sync() {
+  if (fd < 0) return;
+  if (file_len > len) {
+    if (::ftruncate(fd, static_cast<off_t>(len * sizeof(T))) != 0)
+      throw_errno();
+    file_len = len;
+  }
+  if (len > 0 && ::msync(values, bytes_for(len), MS_SYNC) != 0)
+    throw_errno();
+}
+
+template <typename T>
+bool mapped_vector<T>::file_backed() {
+  return fd >= 0;
+}
+
+// private mapped_vector
+
+template <typename T>
+typename mapped_vector<T>::size_type mapped_vector<T>::page_size() {
+  static const size_type size = ::sysconf(_SC_PAGESIZE);
+  return size;
+}
+
+template <typename T>
+typename mapped_vector<T>::size_type mapped_vector<T>::bytes_for(
+    size_type n) {
+  size_type page = page_size();
+  return (n * sizeof(T) + page - 1) / page * page;
+}
+
+template <typename T>
+void mapped_vector<T>::throw_errno() {
+  if (errno == ENOMEM) throw std::bad_alloc();
+  throw std::system_error(errno, std::generic_category());
+}
+
+template <typename T>
+void mapped_vector<T>::apply_advice() {
+  if (values == nullptr) return;
+  int flag = MADV_NORMAL;
+  switch (hint_) {
+    case advice::normal:
+      flag = MADV_NORMAL;
+      break;
+    case advice::sequential:
+      flag = MADV_SEQUENTIAL;
+      break;
+    case advice::random:
+      flag = MADV_RANDOM;
+      break;
+    case advice::will_need:
+      flag = MADV_WILLNEED;
+      break;
+    case advice::huge_pages:
+#ifdef MADV_HUGEPAGE
+      flag = MADV_HUGEPAGE;
+#endif
+      break;
+  }
+  // advice is only a hint: kernels without THP reject MADV_HUGEPAGE
+  ::madvise(values, bytes_for(cap), flag);
+}
+
+template <typename T>
+void mapped_vector<T>::remap(size_type new_cap) {
+  size_type old_bytes = bytes_for(cap);
+  size_type new_bytes = bytes_for(new_cap);
+  void *res = values;
+
+  if (fd >= 0 && new_bytes > old_bytes &&
+      ::ftruncate(fd, static_cast<off_t>(new_bytes)) != 0)
+    throw_errno();
+
+  if (new_bytes == 0) {
+    if (values) ::munmap(values, old_bytes);
+    res = nullptr;
+  } else if (values == nullptr) {
+    int flags = fd >= 0 ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS;
+    res = ::mmap(nullptr, new_bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+  } else if (new_bytes != old_bytes) {
+    res = ::mremap(values, old_bytes, new_bytes, MREMAP_MAYMOVE);
+  }
+  if (res == MAP_FAILED) throw_errno();
+
+  if (fd >= 0 && new_bytes < old_bytes &&
+      ::ftruncate(fd, static_cast<off_t>(new_bytes)) != 0)
+    throw_errno();
+
+  values = static_cast<T *>(res);
+  cap = new_bytes / sizeof(T);
+  file_len = cap;
+  if (hint_ != advice::normal) apply_advice();
+}
+
+// Makes the first new_len elements writable: grows the capacity as
+// needed and lengthens a file that sync() trimmed back to capacity().
+template <typename T>
+void mapped_vector<T>::make_room(size_type new_len) {
+  if (new_len > cap) reserve(cap * 2 > new_len ? cap * 2 : new_len);
+  if (new_len > file_len) {
+    if (::ftruncate(fd, static_cast<off_t>(cap * sizeof(T))) != 0)
+      throw_errno();
+    file_len = cap;
+  }
+}
+
+template <typename T>
+void mapped_vector<T>::release() {
+  if (values) ::munmap(values, bytes_for(cap));
+  if (fd >= 0) {
+    // the file keeps exactly the live elements; a destructor has no way to
+    // report a failure here
+    int res = ::ftruncate(fd, static_cast<off_t>(len * sizeof(T)));
+    (void)res;
+    ::close(fd);
+  }
+  values = nullptr;
+  len = cap = file_len = 0;
+  fd = -1;
+}
+
+}  // namespace my
+
+#endif  // __linux__
+
+#endif  // !_MY_CONTAINER_MAPPED_VECTOR_H
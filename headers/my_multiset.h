@@ -5,27 +5,79 @@
 
 namespace my {
 
-template <typename Key>
-class multiset : public rb_tree<std::pair<Key, int>> {
+// A multiset node stands for as many elements as its counter says.
+struct counter_weight {
+  template <typename Key>
+  size_t operator()(const std::pair<Key, int> &item) const {
+    return item.second;
+  }
+};
+
+// OrderStatistics adds the number of elements below every node for nth(),
+// rank() and count_range(), which count each copy of a key.
+template <typename Key, typename Compare = std::less<Key>,
+          bool OrderStatistics = false>
+class multiset
+    : public rb_tree<
+          std::pair<Key, int>, pair_first_compare<Key, int, Compare>,
+          std::conditional_t<OrderStatistics, counter_weight, void>> {
+  using tree_type =
+      rb_tree<std::pair<Key, int>, pair_first_compare<Key, int, Compare>,
+              std::conditional_t<OrderStatistics, counter_weight, void>>;
+
  public:
   using key_type = Key;
+  using key_compare = Compare;
   using value_type = std::pair<Key, int>;
   using reference = value_type &;
   using const_reference = const value_type &;
-  using const_iterator = typename rb_tree<value_type>::const_iterator;
-  using iterator = typename rb_tree<value_type>::iterator;
+  using const_iterator = typename tree_type::const_iterator;
+  using iterator = typename tree_type::iterator;
   using size_type = size_t;
 
-  multiset() : rb_tree<value_type>() {}
+  multiset() : tree_type() {}
+  explicit multiset(const Compare &comp)
+      : tree_type(pair_first_compare<Key, int, Compare>{comp}) {}
   multiset(std::initializer_list<key_type> const &itmes);
   multiset(std::initializer_list<value_type> const &items);
-  multiset(const multiset &ms) : rb_tree<value_type>(ms) {}
-  multiset(multiset &&ms) noexcept : rb_tree<value_type>(std::move(ms)) {}
+  multiset(const multiset &ms) : tree_type(ms) {}
+  multiset(multiset &&ms) noexcept : tree_type(std::move(ms)) {}
+
+  multiset &operator=(multiset &&ms) noexcept = default;
+
+  template <typename InputIt>
+  static multiset from_sorted(InputIt first, InputIt last,
+                              const Compare &comp = Compare());
+  template <typename InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
+  key_compare key_comp() const;
 
   iterator insert(const Key &value);
+  iterator insert(iterator hint, const Key &value);
+  // Takes keys, sorts them and adds every run of equivalent ones to its
+  // node in a single step, placing the nodes in ascending order as
+  // rb_tree::insert(first, last) does. out gets the node of each key, in
+  // the order of [first, last).
+  template <typename InputIt,
+            typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+  void insert(InputIt first, InputIt last);
+  template <typename InputIt, typename OutputIt,
+            typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+  OutputIt insert(InputIt first, InputIt last, OutputIt out);
+  template <typename... Args>
+  iterator emplace(Args &&...args);
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args);
   bool contains(const Key &key);
   void erase(iterator pos);
+  void merge(multiset &other, unsigned threads = 1);
   size_type count(const Key &key);
+  size_type rank(const Key &key);
+  size_type count_range(const Key &lo, const Key &hi);
+
+  // A node holds every copy of its key, so equal_range(key) spans at most
+  // one node however many copies there are.
   iterator lower_bound(const Key &key);
   iterator upper_bound(const Key &key);
 
@@ -34,198 +86,336 @@ class multiset : public rb_tree<std::pair<Key, int>> {
   std::pair<iterator, iterator> equal_range(const Key &key);
   iterator find(const Key &key);
 
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key);
+
  private:
-  typename rb_tree<value_type>::node *find(
-      typename rb_tree<value_type>::node *root, const Key &key);
-  void operator_eq(typename multiset<Key>::node *&nd1,
-                   typename multiset<Key>::node *&nd2);
-  void swap_pairs(typename multiset<Key>::node *&nd1,
-                  typename multiset<Key>::node *&nd2);
+  typename multiset::node *add_run(typename multiset::node *prev,
+                                   const Key &key, size_type copies);
+
+  // Intersection, difference and node handles have no counted form yet.
+  using tree_type::extract;
+  using tree_type::intersect;
+  using tree_type::subtract;
 };
 
-template <typename Key>
-multiset<Key>::multiset(std::initializer_list<key_type> const &items) {
-  for (auto item : items) this->insert(item);
-}
-
-template <typename Key>
-typename multiset<Key>::iterator multiset<Key>::insert(const Key &value) {
-  typename multiset<Key>::node *new_node;
-  typename multiset<Key>::node *cur = this->root;
-  typename multiset<Key>::node *prev = nullptr;
-  bool stop = false;
-  iterator it;
-
-  while (cur && stop == false) {
-    prev = cur;
-    if (value > cur->key.first)
-      cur = cur->right;
-    else if (value < cur->key.first)
-      cur = cur->left;
-    else {
-      stop = true;
-      cur->key.second++;
-      this->count_++;
-    }
-  }
+template <typename Key, typename Compare, bool OrderStatistics>
+multiset<Key, Compare, OrderStatistics>::multiset(
+    std::initializer_list<key_type> const &items) {
+  assign_sorted(items.begin(), items.end());
+}
 
-  if (!stop) {
-    new_node = new typename multiset<Key>::node(
-        std::pair<key_type, int>(value, 1), prev, rb_tree<value_type>::RED);
-    rb_tree<value_type>::count_++;
-
-    if (prev) {
-      if (new_node->key > prev->key)
-        prev->right = new_node;
-      else
-        prev->left = new_node;
-    } else
-      this->root = new_node;
-    it = rb_tree<value_type>::balance_on_insert(new_node);
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename InputIt>
+multiset<Key, Compare, OrderStatistics>
+multiset<Key, Compare, OrderStatistics>::from_sorted(
+    InputIt first, InputIt last, const Compare &comp) {
+  multiset res(comp);
+  res.assign_sorted(first, last);
+  return res;
+}
+
+// Takes keys rather than (key, count) pairs: runs of equivalent keys are
+// folded into one counted node each.
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename InputIt>
+void multiset<Key, Compare, OrderStatistics>::assign_sorted(
+    InputIt first, InputIt last) {
+  const Compare &comp = this->comp_.comp;
+  Vector<key_type> keys;
+  keys.insert(keys.end(), first, last);
+  if (!std::is_sorted(keys.begin(), keys.end(), comp))
+    std::sort(keys.begin(), keys.end(), comp);
+
+  Vector<value_type> runs;
+  for (key_type &key : keys) {
+    if (!runs.empty() && !comp(runs.back().first, key))
+      runs[runs.size() - 1].second++;
+    else
+      runs.push_back(value_type(std::move(key), 1));
   }
+  this->assign_unique_sorted(std::make_move_iterator(runs.begin()),
+                             runs.size());
+  this->count_ = keys.size();
+}
 
-  return it;
-}
-
-template <typename Key>
-void multiset<Key>::erase(iterator pos) {
-  typename multiset<Key>::node *replace,
-      *delete_node = this->get_iter_node(pos), *tmp = nullptr;
-  if (!delete_node)
-    return;
-  else if (delete_node->key.second > 1)
-    delete_node->key.second--;
-  else if (delete_node == this->root && !this->root->left &&
-           !this->root->right) {
-    delete delete_node;
-    this->root = nullptr;
-    rb_tree<value_type>::count_--;
-  } else {
-    if (delete_node->left && delete_node->right) {
-      replace = delete_node->right;
-      while (replace->left) replace = replace->left;
-      swap_pairs(delete_node, replace);
-    } else
-      replace = delete_node;
-    if (replace->right && !replace->left) {
-      operator_eq(replace, replace->right);
-      tmp = replace->right;
-      replace->right = nullptr;
-      delete tmp;
-    } else if (replace->left && !replace->right) {
-      operator_eq(replace, replace->left);
-      tmp = replace->left;
-      replace->left = nullptr;
-      delete tmp;
-    } else {
-      typename multiset<Key>::node *tmp_parent;
-      typename rb_tree<value_type>::node_colors color = replace->color;
-      tmp = replace;
-      if (replace != this->root) {
-        if (replace->parent->left == replace) replace->parent->left = nullptr;
-        if (replace->parent->right == replace) replace->parent->right = nullptr;
-      }
-      tmp_parent = replace->parent;
-
-      delete tmp;
-      if (color == rb_tree<value_type>::BLACK)
-        this->balance_on_delete(tmp_parent, nullptr);
-    }
-    rb_tree<value_type>::count_--;
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::key_compare
+multiset<Key, Compare, OrderStatistics>::key_comp() const {
+  return this->comp_.comp;
+}
+
+// Equal keys share one node carrying a counter, so inserting a duplicate
+// only bumps it.
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::insert(const Key &value) {
+  typename multiset::insert_position pos = this->find_insert_pos(value);
+
+  if (pos.existing) {
+    pos.existing->key.second++;
+    this->refresh_weights(pos.existing);
+    this->count_++;
+    return iterator(pos.existing);
   }
+  return this->insert_at(pos, value, 1);
 }
 
-template <typename Key>
-typename multiset<Key>::size_type multiset<Key>::count(const Key &key) {
-  size_type res = 0;
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::insert(iterator hint,
+                                                const Key &value) {
+  return emplace_hint(hint, value);
+}
 
-  auto nd = find(this->root, key);
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename InputIt, typename>
+void multiset<Key, Compare, OrderStatistics>::insert(InputIt first,
+                                                     InputIt last) {
+  const Compare &comp = this->comp_.comp;
+  Vector<key_type> keys;
+  keys.insert(keys.end(), first, last);
+  if (!std::is_sorted(keys.begin(), keys.end(), comp))
+    std::sort(keys.begin(), keys.end(), comp);
+
+  typename multiset::node *prev = nullptr;
+  for (size_type i = 0; i < keys.size();) {
+    size_type j = i + 1;
+    while (j < keys.size() && !comp(keys[i], keys[j])) j++;
+    prev = add_run(prev, keys[i], j - i);
+    i = j;
+  }
+}
 
-  if (nd == nullptr)
-    res = 0;
-  else
-    res = nd->key.second;
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename InputIt, typename OutputIt, typename>
+OutputIt multiset<Key, Compare, OrderStatistics>::insert(InputIt first,
+                                                         InputIt last,
+                                                         OutputIt out) {
+  const Compare &comp = this->comp_.comp;
+  Vector<key_type> keys;
+  keys.insert(keys.end(), first, last);
+  size_type n = keys.size();
+  Vector<size_type> order(n);
+  for (size_type i = 0; i < n; i++) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](size_type a, size_type b) {
+    return comp(keys[a], keys[b]);
+  });
+
+  Vector<typename multiset::node *> placed(n);
+  typename multiset::node *prev = nullptr;
+  for (size_type i = 0; i < n;) {
+    size_type j = i + 1;
+    while (j < n && !comp(keys[order[i]], keys[order[j]])) j++;
+    prev = add_run(prev, keys[order[i]], j - i);
+    for (; i < j; i++) placed[order[i]] = prev;
+  }
 
-  return res;
+  for (size_type i = 0; i < n; i++, ++out) *out = iterator(placed[i]);
+  return out;
 }
 
-template <typename Key>
-bool multiset<Key>::contains(const Key &key) {
-  return find(key) != nullptr;
+// Adds copies of key, ordered after the key of prev, and returns its node.
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::node *
+multiset<Key, Compare, OrderStatistics>::add_run(
+    typename multiset::node *prev, const Key &key, size_type copies) {
+  typename multiset::insert_position pos = this->find_pos_after(prev, key);
+
+  if (pos.existing) {
+    pos.existing->key.second += copies;
+    this->refresh_weights(pos.existing);
+    this->count_ += copies;
+    return pos.existing;
+  }
+  typename multiset::node *nd =
+      this->get_iter_node(this->insert_at(pos, key, int(copies)));
+  this->count_ += copies - 1;
+  return nd;
 }
 
-template <typename Key>
-typename multiset<Key>::iterator multiset<Key>::lower_bound(const Key &key) {
-  typename multiset<Key>::iterator res;
-  bool stop = false;
+// The arguments of emplace() and emplace_hint() build a key, not a
+// (key, count) node.
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename... Args>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::emplace(Args &&...args) {
+  return insert(Key(std::forward<Args>(args)...));
+}
 
-  for (auto it = this->begin(); it != this->end() && !stop; it++) {
-    if ((*it).first >= key) {
-      res = it;
-      stop = true;
-    }
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename... Args>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::emplace_hint(iterator hint,
+                                                      Args &&...args) {
+  Key key(std::forward<Args>(args)...);
+  typename multiset::insert_position pos =
+      this->find_hint_pos(this->get_iter_node(hint), key);
+
+  if (pos.existing) {
+    pos.existing->key.second++;
+    this->refresh_weights(pos.existing);
+    this->count_++;
+    return iterator(pos.existing);
   }
-  return res;
+  return this->insert_at(pos, std::move(key), 1);
 }
 
-template <typename Key>
-typename multiset<Key>::iterator multiset<Key>::upper_bound(const Key &key) {
-  typename multiset<Key>::iterator res;
-  bool stop = false;
+// Drops one copy of the key; the node goes once its last copy does.
+template <typename Key, typename Compare, bool OrderStatistics>
+void multiset<Key, Compare, OrderStatistics>::erase(iterator pos) {
+  typename multiset::node *nd = this->get_iter_node(pos);
+  if (!nd || nd->is_header) return;
 
-  for (auto it = this->begin(); it != this->end() && !stop; it++) {
-    if ((*it).first <= key) {
-      res = it;
-      stop = true;
-    }
+  if (nd->key.second > 1) {
+    nd->key.second--;
+    this->refresh_weights(nd);
+    this->count_--;
+  } else {
+    tree_type::erase(pos);
   }
-  return res;
 }
 
-template <typename Key>
-typename multiset<Key>::iterator multiset<Key>::find(const Key &key) {
-  return iterator(find(this->root, key));
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::size_type
+multiset<Key, Compare, OrderStatistics>::count(const Key &key) {
+  typename multiset::node *nd = this->find_node(key);
+
+  return nd ? nd->key.second : 0;
 }
 
-template <typename Key>
-typename rb_tree<std::pair<Key, int>>::node *multiset<Key>::find(
-    typename rb_tree<std::pair<Key, int>>::node *root, const Key &key) {
-  if (root == nullptr) return nullptr;
-  typename multiset<Key>::node *res;
-  if (root->key.first == key)
-    res = root;
-  else if (root->key.first < key)
-    res = find(root->right, key);
-  else if (root->key.first > key)
-    res = find(root->left, key);
-  return res;
+// Splices in the keys this multiset lacks along with their counts; keys
+// present in both stay in other. size() counts every copy, so both sizes
+// are settled from the counters of what is left in other.
+template <typename Key, typename Compare, bool OrderStatistics>
+void multiset<Key, Compare, OrderStatistics>::merge(
+    multiset &other, unsigned threads) {
+  if (this == &other) return;
+  size_type total = this->count_ + other.count_;
+  tree_type::merge(other, threads);
+
+  other.count_ = 0;
+  for (auto it = other.begin(); it != other.end(); ++it)
+    other.count_ += (*it).second;
+  this->count_ = total - other.count_;
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+bool multiset<Key, Compare, OrderStatistics>::contains(const Key &key) {
+  return this->find_node(key) != nullptr;
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::size_type
+multiset<Key, Compare, OrderStatistics>::rank(const Key &key) {
+  return this->rank_of(key);
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::size_type
+multiset<Key, Compare, OrderStatistics>::count_range(
+    const Key &lo, const Key &hi) {
+  return this->count_range_of(lo, hi);
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::lower_bound(const Key &key) {
+  typename multiset::node *res = this->lower_bound_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::upper_bound(const Key &key) {
+  typename multiset::node *res = this->upper_bound_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename K, typename C, typename>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::lower_bound(const K &key) {
+  typename multiset::node *res = this->lower_bound_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename K, typename C, typename>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::upper_bound(const K &key) {
+  typename multiset::node *res = this->upper_bound_node(key);
+  return res ? iterator(res) : this->end();
 }
 
-template <typename Key>
-std::pair<typename multiset<Key>::iterator, typename multiset<Key>::iterator>
-multiset<Key>::equal_range(const Key &key) {
-  return std::pair(find(key), find(key));
+template <typename Key, typename Compare, bool OrderStatistics>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::find(const Key &key) {
+  typename multiset::node *res = this->find_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename K, typename C, typename>
+typename multiset<Key, Compare, OrderStatistics>::iterator
+multiset<Key, Compare, OrderStatistics>::find(const K &key) {
+  typename multiset::node *res = this->find_node(key);
+  return res ? iterator(res) : this->end();
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename K, typename C, typename>
+bool multiset<Key, Compare, OrderStatistics>::contains(const K &key) {
+  return this->find_node(key) != nullptr;
+}
+
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename K, typename C, typename>
+typename multiset<Key, Compare, OrderStatistics>::size_type
+multiset<Key, Compare, OrderStatistics>::count(const K &key) {
+  typename multiset::node *nd = this->find_node(key);
+
+  return nd ? nd->key.second : 0;
 }
 
-template <typename Key>
-void multiset<Key>::operator_eq(typename multiset<Key>::node *&nd1,
-                                typename multiset<Key>::node *&nd2) {
-  nd1->key.first = nd2->key.first;
-  nd1->key.second = nd2->key.second;
+template <typename Key, typename Compare, bool OrderStatistics>
+std::pair<typename multiset<Key, Compare, OrderStatistics>::iterator,
+          typename multiset<Key, Compare, OrderStatistics>::iterator>
+multiset<Key, Compare, OrderStatistics>::equal_range(const Key &key) {
+  return this->equal_range_of(key);
 }
 
-template <typename Key>
-void multiset<Key>::swap_pairs(typename multiset<Key>::node *&nd1,
-                               typename multiset<Key>::node *&nd2) {
-  std::swap(nd1->key.first, nd2->key.first);
-  std::swap(nd1->key.second, nd2->key.second);
+template <typename Key, typename Compare, bool OrderStatistics>
+template <typename K, typename C, typename>
+std::pair<typename multiset<Key, Compare, OrderStatistics>::iterator,
+          typename multiset<Key, Compare, OrderStatistics>::iterator>
+multiset<Key, Compare, OrderStatistics>::equal_range(const K &key) {
+  return this->equal_range_of(key);
 }
 
-template <typename Key>
+template <typename Key, typename Compare, bool OrderStatistics>
 template <typename... Args>
-Vector<std::pair<typename multiset<Key>::iterator, bool>>
-multiset<Key>::insert_many(Args &&...args) {
+Vector<std::pair<typename multiset<Key, Compare, OrderStatistics>::iterator,
+                 bool>>
+multiset<Key, Compare, OrderStatistics>::insert_many(Args &&...args) {
   Vector<std::pair<iterator, bool>> res;
+  res.reserve(sizeof...(Args));
 
   size_type count = sizeof...(Args);
   if (count == 0) throw std::runtime_error("Error: Zero args");
@@ -0,0 +1,132 @@
+#ifndef _MY_CONTAINER_NODE_POOL_H
+#define _MY_CONTAINER_NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace my {
+
+// Slab allocator for the fixed-size nodes of the node-based containers.
+// Nodes are carved out of chunks whose size doubles up to max_chunk_nodes;
+// freed nodes go to an intrusive free list and are handed out again before
+// any new chunk is requested. release() returns every chunk at once, so a
+// container whose nodes need no destructor tears down in O(chunks).
+//
+// The pool only hands out raw storage: constructing and destroying the
+// node objects is up to the container.
+template <typename Node>
+class node_pool {
+ public:
+  static constexpr std::size_t min_chunk_nodes = 4;
+  static constexpr std::size_t max_chunk_nodes = 1024;
+
+  node_pool() = default;
+  node_pool(const node_pool &other) = delete;
+  node_pool(node_pool &&other) noexcept;
+  ~node_pool();
+
+  node_pool &operator=(const node_pool &other) = delete;
+  node_pool &operator=(node_pool &&other) noexcept;
+
+  void *allocate();
+  void deallocate(void *p) noexcept;
+  void release() noexcept;
+  void swap(node_pool &other) noexcept;
+
+ private:
+  union slot {
+    slot *next;
+    alignas(Node) unsigned char storage[sizeof(Node)];
+  };
+
+  struct alignas(alignof(slot)) chunk {
+    chunk *next;
+
+    slot *slots() { return reinterpret_cast<slot *>(this + 1); }
+  };
+
+  void add_chunk();
+
+  chunk *chunks_ = nullptr;
+  slot *free_ = nullptr;
+  slot *bump_ = nullptr;
+  slot *bump_end_ = nullptr;
+  std::size_t next_chunk_nodes_ = min_chunk_nodes;
+};
+
+template <typename Node>
+node_pool<Node>::node_pool(node_pool &&other) noexcept {
+  swap(other);
+}
+
+template <typename Node>
+node_pool<Node>::~node_pool() {
+  release();
+}
+
+template <typename Node>
+node_pool<Node> &node_pool<Node>::operator=(node_pool &&other) noexcept {
+  if (this != &other) {
+    release();
+    swap(other);
+  }
+  return *this;
+}
+
+template <typename Node>
+void *node_pool<Node>::allocate() {
+  slot *res;
+  if (free_) {
+    res = free_;
+    free_ = free_->next;
+  } else {
+    if (bump_ == bump_end_) add_chunk();
+    res = bump_++;
+  }
+  return res->storage;
+}
+
+template <typename Node>
+void node_pool<Node>::deallocate(void *p) noexcept {
+  slot *s = reinterpret_cast<slot *>(p);
+  s->next = free_;
+  free_ = s;
+}
+
+template <typename Node>
+void node_pool<Node>::release() noexcept {
+  while (chunks_) {
+    chunk *next = chunks_->next;
+    ::operator delete(chunks_, std::align_val_t(alignof(chunk)));
+    chunks_ = next;
+  }
+  free_ = bump_ = bump_end_ = nullptr;
+  next_chunk_nodes_ = min_chunk_nodes;
+}
+
+template <typename Node>
+void node_pool<Node>::swap(node_pool &other) noexcept {
+  std::swap(chunks_, other.chunks_);
+  std::swap(free_, other.free_);
+  std::swap(bump_, other.bump_);
+  std::swap(bump_end_, other.bump_end_);
+  std::swap(next_chunk_nodes_, other.next_chunk_nodes_);
+}
+
+template <typename Node>
+void node_pool<Node>::add_chunk() {
+  std::size_t n = next_chunk_nodes_;
+  void *mem = ::operator new(sizeof(chunk) + n * sizeof(slot),
+                             std::align_val_t(alignof(chunk)));
+  chunk *c = static_cast<chunk *>(mem);
+  c->next = chunks_;
+  chunks_ = c;
+  bump_ = c->slots();
+  bump_end_ = bump_ + n;
+  if (next_chunk_nodes_ < max_chunk_nodes) next_chunk_nodes_ *= 2;
+}
+
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_NODE_POOL_H
@@ -1,23 +1,87 @@
 #ifndef _MY_CONTAINER_RBTREE_H
 #define _MY_CONTAINER_RBTREE_H
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "my_node_pool.h"
+#include "my_vector.h"
 
 namespace my {
 
-template <typename T>
+// Orders the pairs stored by map and multiset by their first member alone.
+// Lookups hand in bare keys, so a pair also compares against any key type
+// that Compare accepts.
+template <typename Key, typename T, typename Compare>
+struct pair_first_compare {
+  using pair_type = std::pair<Key, T>;
+
+  Compare comp;
+
+  bool operator()(const pair_type &a, const pair_type &b) const {
+    return comp(a.first, b.first);
+  }
+  template <typename K>
+  bool operator()(const pair_type &a, const K &b) const {
+    return comp(a.first, b);
+  }
+  template <typename K>
+  bool operator()(const K &a, const pair_type &b) const {
+    return comp(a, b.first);
+  }
+  bool operator()(const Key &a, const Key &b) const { return comp(a, b); }
+};
+
+// Every element counts once towards the order statistics of a set.
+struct unit_weight {
+  template <typename V>
+  size_t operator()(const V &) const {
+    return 1;
+  }
+};
+
+// The total weight of a subtree, only stored in the nodes of trees with
+// order statistics.
+template <bool Enabled>
+struct subtree_weight_field {};
+
+template <>
+struct subtree_weight_field<true> {
+  size_t weight = 0;
+};
+
+// Weight, unless void, turns on order statistics: it tells how many
+// elements a node stands for, and every node caches the total weight of
+// its subtree so that nth(), rank() and count_range() can descend by it.
+template <typename T, typename Compare = std::less<T>, typename Weight = void>
 class rb_tree {
  public:
   class iterator;
   class const_iterator;
+  class node_type;
+  struct insert_return_type;
 
   using value_type = T;
   using reference = T &;
   using const_reference = const T &;
   using size_type = size_t;
+  using value_compare = Compare;
+  using weight_type = Weight;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+
+  static constexpr bool order_statistics = !std::is_void_v<Weight>;
 
   rb_tree();
+  explicit rb_tree(const Compare &comp);
   rb_tree(const rb_tree &other);
   rb_tree(rb_tree &&other) noexcept;
   ~rb_tree();
@@ -25,26 +89,122 @@ class rb_tree {
 
   iterator begin();
   iterator end();
+  reverse_iterator rbegin();
+  reverse_iterator rend();
 
   bool empty();
   size_type size();
   size_type max_size();
+  value_compare value_comp() const;
 
   void clear();
   std::pair<iterator, bool> insert(value_type key);
+  // hint is a guess at the element key goes right before or after. A good
+  // hint, or end() while keys come in ascending order, spares the descent
+  // from the root.
+  iterator insert(iterator hint, value_type key);
+  // Bulk insert: the batch is sorted and then placed in ascending order,
+  // every position found by a short climb from the one placed before it
+  // rather than a descent from the root. Of equivalent elements the first
+  // one wins. The second form also writes what insert(value) would have
+  // returned for each element to out, in the order of [first, last).
+  template <typename InputIt,
+            typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+  void insert(InputIt first, InputIt last);
+  template <typename InputIt, typename OutputIt,
+            typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+  OutputIt insert(InputIt first, InputIt last, OutputIt out);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args);
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args);
   void erase(iterator pos);
   void swap(rb_tree &other);
-  void merge(rb_tree &other);
+
+  // Unlink an element together with its node, which can be put back into
+  // this tree or another one of the same type, e.g. after changing the
+  // key. Putting it back only relinks the node: nothing is allocated or
+  // copied, whichever tree it goes to.
+  node_type extract(iterator pos);
+  node_type extract(const_reference key);
+  insert_return_type insert(node_type &&nh);
+
+  // Set algebra by splitting and joining subtrees, in O(m log(n/m + 1))
+  // time for operands of sizes m <= n. merge() moves over the
+  // elements of other that this tree lacks and leaves the rest in other.
+  // intersect() and subtract() keep the elements that are, respectively
+  // are not, found in other, whose contents stay as they were. With
+  // threads > 1 large operands are processed on that many threads.
+  void merge(rb_tree &other, unsigned threads = 1);
+  void intersect(rb_tree &other, unsigned threads = 1);
+  void subtract(rb_tree &other, unsigned threads = 1);
+
+  // Replaces the contents with [first, last) in linear time when the range
+  // is already sorted; any other range is sorted first. Of equivalent
+  // elements the first one is kept.
+  template <typename InputIt>
+  void assign_sorted(InputIt first, InputIt last);
 
   iterator find(const_reference key);
   bool contains(const_reference key);
 
+  // Lookups by any type the comparator orders against value_type, enabled
+  // for transparent comparators such as std::less<>.
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key);
+
+  // Bounds by one descent from the root: lower_bound(key) is the first
+  // element not ordered before key, upper_bound(key) the first one ordered
+  // after it and equal_range(key) the half-open range between the two.
+  iterator lower_bound(const_reference key);
+  iterator upper_bound(const_reference key);
+  std::pair<iterator, iterator> equal_range(const_reference key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key);
+
+  // Writes find(key) for every key of [first, last) to out, in the order
+  // of the keys. Up to find_many_lanes descents advance in turns, each one
+  // prefetching the node it moves to, so their cache misses overlap instead
+  // of following one another. With sort_batch the keys of every block are
+  // looked up in ascending order, so that consecutive descents find the
+  // top of their paths already cached; keys the comparator cannot order
+  // among themselves are looked up as they come.
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out,
+                     bool sort_batch = false);
+
+  // Order statistics, in O(log n) and only for trees with a Weight. nth(k)
+  // is the element covering index k of the sorted sequence (end() past
+  // the last one), rank(key) the number of elements ordered before key
+  // and count_range(lo, hi) the number of them in [lo, hi).
+  iterator nth(size_type k);
+  size_type rank(const_reference key);
+  size_type count_range(const_reference lo, const_reference hi);
+
  protected:
   struct node;
+  struct shared_pool;
 
  public:
   class iterator {
    public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
     friend node *rb_tree::get_iter_node(iterator it);
     iterator();
     iterator(node *nd);
@@ -54,13 +214,12 @@ class rb_tree {
     bool operator!=(const iterator &other) const;
     iterator &operator++();
     iterator operator++(int);
+    iterator &operator--();
+    iterator operator--(int);
     iterator &operator=(const iterator &other);
 
    protected:
     node *iter_node = nullptr;
-
-   private:
-    node *next(node *nd);
   };
 
   class const_iterator : public iterator {
@@ -68,351 +227,1346 @@ class rb_tree {
     const_reference operator*() const;
   };
 
+  // Owns a node taken out by extract(). The handle holds on to the pool
+  // the node came from, so it outlives whatever happens to that tree, and
+  // so does the tree it is inserted into, for as long as the node is there.
+  // The node goes back to its own pool when it is destroyed, from any
+  // thread, so trees that exchanged nodes stay independent otherwise.
+  class node_type {
+   public:
+    node_type() = default;
+    node_type(node_type &&other) noexcept;
+    ~node_type();
+    node_type &operator=(node_type &&other) noexcept;
+
+    bool empty() const;
+    explicit operator bool() const;
+    reference value() const;
+    // For trees of pairs, such as map.
+    auto &key() const { return nd_->key.first; }
+    auto &mapped() const { return nd_->key.second; }
+
+   private:
+    friend class rb_tree;
+
+    node_type(node *nd, std::shared_ptr<shared_pool> pool);
+    void reset();
+
+    node *nd_ = nullptr;
+    std::shared_ptr<shared_pool> pool_;
+  };
+
+  struct insert_return_type {
+    iterator position;
+    bool inserted;
+    node_type node;
+  };
+
  protected:
   enum node_colors : bool { RED, BLACK };
 
-  struct node {
-    value_type key;
+  // The header is a node without a key. The root's parent points to it,
+  // its left and right cache the leftmost and rightmost nodes and it
+  // doubles as end(). Leaves still have null children.
+  struct node : subtree_weight_field<order_statistics> {
+    union {
+      value_type key;
+    };
     node *parent = nullptr;
     node *left = nullptr;
     node *right = nullptr;
-    node_colors color;
+    node_colors color = RED;
+    bool is_header = false;
+    shared_pool *owner = nullptr;
+
+    node();
+    template <typename Arg, typename... Args>
+    explicit node(Arg &&arg, Args &&...args);
+    ~node();
+  };
+
+  // Where a key goes: under parent on the given side, unless an equivalent
+  // key already lives in existing.
+  struct insert_position {
+    node *parent;
+    bool left;
+    node *existing;
+  };
 
-    node(value_type key, node *parent, node_colors color);
+  // A detached subtree with the black height it has once its root is
+  // painted black. Passing the height along saves join() from measuring
+  // its operands.
+  struct subtree {
+    node *root = nullptr;
+    size_type height = 0;
   };
 
+  // The pieces of a subtree cut around a key, with the node equivalent to
+  // it (if any) in match.
+  struct split_parts {
+    subtree left;
+    node *match;
+    subtree right;
+  };
+
+  enum class set_op { unite, intersect, subtract };
+
+  // Outcome of combining two subtrees: the nodes of the result, what is
+  // left of the second operand and the nodes of the first one that did
+  // not make it into the result.
+  struct combined {
+    subtree kept;
+    subtree rest;
+    subtree dropped;
+  };
+
+  // The node pool of a tree, also held by the handles of nodes taken out
+  // of it and by the trees those nodes went to. Only the tree allocates
+  // from nodes and hands its own nodes back there; anyone else gives a
+  // node back through returned, which the tree drains when it allocates.
+  struct shared_pool {
+    struct returned_node {
+      returned_node *next;
+    };
+
+    node_pool<node> nodes;
+    std::atomic<returned_node *> returned{nullptr};
+
+    void give_back(node *nd) noexcept;
+    void reclaim() noexcept;
+    void release() noexcept;
+  };
+
+  // Operands with fewer elements than this are never split across threads.
+  static constexpr size_type parallel_min_size = size_type(1) << 14;
+
+  // find_many interleaves this many descents and buffers the results of
+  // up to find_many_block keys before writing them out in order.
+  static constexpr size_type find_many_lanes = 16;
+  static constexpr size_type find_many_block = 256;
+
  protected:
-  node *find(node *root, const_reference key);
+  template <typename K>
+  node *find_node(const K &key);
+  template <typename K>
+  node *lower_bound_node(const K &key);
+  template <typename K>
+  node *upper_bound_node(const K &key);
+  template <typename K>
+  std::pair<iterator, iterator> equal_range_of(const K &key);
+  template <typename K>
+  insert_position find_insert_pos(const K &key);
+  template <typename K>
+  insert_position find_insert_pos_in(node *top, const K &key);
+  template <typename K>
+  insert_position find_hint_pos(node *hint, const K &key);
+  template <typename K>
+  insert_position find_pos_after(node *prev, const K &key);
+  template <typename K>
+  size_type rank_of(const K &key);
+  template <typename K>
+  size_type count_range_of(const K &lo, const K &hi);
+  template <typename... Args>
+  iterator insert_at(const insert_position &pos, Args &&...args);
+  template <typename It>
+  void assign_unique_sorted(It first, size_type n);
+  void assign_buffer(Vector<value_type> &buf, bool keep_last);
+  template <typename It>
+  node *build_sorted(It &it, size_type n, size_type depth,
+                     size_type red_depth);
+  template <typename... Args>
+  node *create_node(Args &&...args);
+  void destroy_node(node *nd);
+  shared_pool &pool();
+  std::shared_ptr<shared_pool> share_of(const node *nd);
+  void borrow(const std::shared_ptr<shared_pool> &share);
   node *copy(node *nd, node *parent);
-  void free_node(node *nd);
+  void free_tree();
+  static node *successor(node *nd);
+  static node *predecessor(node *nd);
   void left_rotate(node *x);
   void right_rotate(node *y);
   iterator balance_on_insert(node *nd);
-  void balance_on_delete(node *parent, node *prev);
-  void balance_on_delete_red_par(node *parent, node *prev);
-  void balance_on_delete_black_pair_left(node *parent, node *child);
-  void balance_on_delete_black_pair_right(node *parent, node *child);
+  void unlink_node(node *nd);
+  void transplant(node *old_child, node *new_child);
+  void balance_after_unlink(node *x, node *parent);
+  static bool is_black(const node *nd);
   node *get_iter_node(iterator it);
+  iterator link_node(node *nd, node *parent, bool left);
+  void reset_header();
+  void adopt_root(node *new_root);
+  static size_type subtree_weight(const node *nd);
+  static void update_weight(node *nd);
+  static void refresh_weights(node *nd);
+
+  template <set_op Op>
+  combined combine(subtree t1, subtree t2, int forks);
+  split_parts split(subtree t, const_reference key);
+  static subtree join(subtree left, node *mid, subtree right);
+  static subtree join2(subtree left, subtree right);
+  static node *join_right(node *t, size_type height, node *mid, node *right,
+                          size_type right_height);
+  static node *join_left(node *t, size_type height, node *mid, node *left,
+                         size_type left_height);
+  static subtree split_last(subtree t, node *&last);
+  static node *attach(node *mid, node *left, node *right, node_colors color);
+  static subtree detach(node *t);
+  static subtree detach_child(node *child, size_type height);
+  static int fork_levels(unsigned threads, size_type n, size_type m);
+  template <typename F>
+  static void for_each_node(node *t, F &&f);
 
  protected:
   node *root;
   size_type count_ = 0;
+  node header_;
+  std::shared_ptr<shared_pool> pool_;
+  // The pools of the nodes that came over from other trees.
+  Vector<std::shared_ptr<shared_pool>> borrowed_;
+  Compare comp_;
 };
 
-template <typename T>
-rb_tree<T>::node::node(value_type key, node *parent, node_colors color)
-    : key(key), parent(parent), color(color) {}
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::node::node() : color(BLACK), is_header(true) {}
 
-template <typename T>
-rb_tree<T>::rb_tree() : root(nullptr) {}
+template <typename T, typename Compare, typename Weight>
+template <typename Arg, typename... Args>
+rb_tree<T, Compare, Weight>::node::node(Arg &&arg, Args &&...args)
+    : key(std::forward<Arg>(arg), std::forward<Args>(args)...) {}
 
-template <typename T>
-rb_tree<T>::rb_tree(const rb_tree &other) : root(nullptr) {
-  if (this != &other) {
-    this->root = copy(other.root, nullptr);
-    count_ = other.count_;
-  }
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::node::~node() {
+  if (!is_header) key.~value_type();
 }
 
-template <typename T>
-rb_tree<T>::rb_tree(rb_tree &&other) noexcept {
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::rb_tree() : root(nullptr) {
+  reset_header();
+}
+
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::rb_tree(const Compare &comp)
+    : root(nullptr), comp_(comp) {
+  reset_header();
+}
+
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::rb_tree(const rb_tree &other)
+    : root(nullptr), comp_(other.comp_) {
+  reset_header();
   if (this != &other) {
-    root = other.root;
+    adopt_root(copy(other.root, nullptr));
     count_ = other.count_;
-    other.root = nullptr;
-    other.count_ = 0;
   }
 }
 
-template <typename T>
-rb_tree<T>::~rb_tree() {
-  free_node(root);
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::rb_tree(rb_tree &&other) noexcept
+    : root(nullptr),
+      count_(other.count_),
+      pool_(std::move(other.pool_)),
+      borrowed_(std::move(other.borrowed_)),
+      comp_(other.comp_) {
+  reset_header();
+  adopt_root(other.root);
+  other.reset_header();
+  other.count_ = 0;
+}
+
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::~rb_tree() {
+  free_tree();
 }
 
-template <typename T>
-rb_tree<T> &rb_tree<T>::operator=(rb_tree &&other) noexcept {
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight> &rb_tree<T, Compare, Weight>::operator=(
+    rb_tree &&other) noexcept {
   if (this != &other) {
-    root = other.root;
-    other.root = nullptr;
+    clear();
+    swap(other);
   }
 
   return *this;
 }
 
-template <typename T>
-typename rb_tree<T>::iterator rb_tree<T>::begin() {
-  node *cur = root;
-  node *prev = nullptr;
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::begin() {
+  return iterator(header_.left);
+}
 
-  while (cur) {
-    prev = cur;
-    cur = cur->left;
-  }
-  return rb_tree<T>::iterator(prev);
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::end() {
+  return iterator(&header_);
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::reverse_iterator
+rb_tree<T, Compare, Weight>::rbegin() {
+  return reverse_iterator(end());
 }
 
-template <typename T>
-typename rb_tree<T>::iterator rb_tree<T>::end() {
-  return iterator(nullptr);
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::reverse_iterator
+rb_tree<T, Compare, Weight>::rend() {
+  return reverse_iterator(begin());
 }
 
-template <typename T>
-inline bool rb_tree<T>::empty() {
+template <typename T, typename Compare, typename Weight>
+inline bool rb_tree<T, Compare, Weight>::empty() {
   return root == nullptr;
 }
 
-template <typename T>
-inline size_t rb_tree<T>::size() {
+template <typename T, typename Compare, typename Weight>
+inline size_t rb_tree<T, Compare, Weight>::size() {
   return count_;
 }
 
-template <typename T>
-inline size_t rb_tree<T>::max_size() {
-  return std::numeric_limits<size_type>::max() /
-         sizeof(typename rb_tree<T>::node);
+template <typename T, typename Compare, typename Weight>
+inline size_t rb_tree<T, Compare, Weight>::max_size() {
+  return std::numeric_limits<size_type>::max() / sizeof(node);
 }
 
-template <typename T>
-void rb_tree<T>::clear() {
-  free_node(root);
-  root = nullptr;
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::value_compare
+rb_tree<T, Compare, Weight>::value_comp() const {
+  return comp_;
+}
+
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::clear() {
+  free_tree();
+  reset_header();
   count_ = 0;
 }
 
-template <typename T>
-typename std::pair<typename rb_tree<T>::iterator, bool> rb_tree<T>::insert(
-    value_type key) {
-  node *new_node;
-  node *cur = root;
+template <typename T, typename Compare, typename Weight>
+typename std::pair<typename rb_tree<T, Compare, Weight>::iterator, bool>
+rb_tree<T, Compare, Weight>::insert(value_type key) {
+  insert_position pos = find_insert_pos(key);
+
+  if (pos.existing) return std::pair<iterator, bool>(pos.existing, false);
+  return std::pair<iterator, bool>(insert_at(pos, std::move(key)), true);
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node_type
+rb_tree<T, Compare, Weight>::extract(iterator pos) {
+  node *nd = get_iter_node(pos);
+  if (!nd || nd->is_header) return node_type();
+
+  unlink_node(nd);
+  nd->parent = nd->left = nd->right = nullptr;
+  return node_type(nd, share_of(nd));
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node_type
+rb_tree<T, Compare, Weight>::extract(const_reference key) {
+  node *nd = find_node(key);
+  return nd ? extract(iterator(nd)) : node_type();
+}
+
+// A node from another tree stays in that tree's pool, which this tree
+// holds on to from now on.
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::insert_return_type
+rb_tree<T, Compare, Weight>::insert(node_type &&nh) {
+  if (nh.empty()) return {end(), false, node_type()};
+
+  insert_position pos = find_insert_pos(nh.nd_->key);
+  if (pos.existing) return {iterator(pos.existing), false, std::move(nh)};
+
+  borrow(nh.pool_);
+  node *nd = nh.nd_;
+  nh.nd_ = nullptr;
+  nh.pool_.reset();
+  return {link_node(nd, pos.parent, pos.left), true, node_type()};
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::insert(iterator hint, value_type key) {
+  insert_position pos = find_hint_pos(get_iter_node(hint), key);
+
+  if (pos.existing) return iterator(pos.existing);
+  return insert_at(pos, std::move(key));
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename InputIt, typename>
+void rb_tree<T, Compare, Weight>::insert(InputIt first, InputIt last) {
+  Vector<value_type> buf;
+  buf.insert(buf.end(), first, last);
+  if (!std::is_sorted(buf.begin(), buf.end(), comp_))
+    std::stable_sort(buf.begin(), buf.end(), comp_);
+
   node *prev = nullptr;
-  bool stop = false;
-  bool res = false;
-  iterator it;
+  for (value_type &value : buf) {
+    insert_position pos = find_pos_after(prev, value);
+    prev = pos.existing ? pos.existing
+                        : get_iter_node(insert_at(pos, std::move(value)));
+  }
+}
 
-  while (cur && stop == false) {
-    prev = cur;
-    if (key > cur->key)
-      cur = cur->right;
-    else if (key < cur->key)
-      cur = cur->left;
-    else
-      stop = true;
+// Sorts positions into the batch instead of the elements themselves, so
+// the results can be written out in the order the elements came in.
+template <typename T, typename Compare, typename Weight>
+template <typename InputIt, typename OutputIt, typename>
+OutputIt rb_tree<T, Compare, Weight>::insert(InputIt first, InputIt last,
+                                             OutputIt out) {
+  Vector<value_type> buf;
+  buf.insert(buf.end(), first, last);
+  size_type n = buf.size();
+  Vector<size_type> order(n);
+  for (size_type i = 0; i < n; i++) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_type a, size_type b) {
+                     return comp_(buf[a], buf[b]);
+                   });
+
+  Vector<std::pair<node *, bool>> placed(n);
+  node *prev = nullptr;
+  for (size_type i : order) {
+    insert_position pos = find_pos_after(prev, buf[i]);
+    if (pos.existing) {
+      placed[i] = {pos.existing, false};
+    } else {
+      placed[i] = {get_iter_node(insert_at(pos, std::move(buf[i]))), true};
+    }
+    prev = placed[i].first;
   }
 
-  if (!stop) {
-    new_node = new node(key, prev, RED);
-    count_++;
+  for (size_type i = 0; i < n; i++, ++out)
+    *out = std::pair<iterator, bool>(iterator(placed[i].first),
+                                     placed[i].second);
+  return out;
+}
 
-    if (prev) {
-      if (new_node->key > prev->key)
-        prev->right = new_node;
-      else
-        prev->left = new_node;
-    } else
-      root = new_node;
-    it = balance_on_insert(new_node);
-    res = true;
+// The element is built first since its key is needed to place it; it is
+// dropped again when an equivalent one is already there.
+template <typename T, typename Compare, typename Weight>
+template <typename... Args>
+typename std::pair<typename rb_tree<T, Compare, Weight>::iterator, bool>
+rb_tree<T, Compare, Weight>::emplace(Args &&...args) {
+  node *nd = create_node(std::forward<Args>(args)...);
+  insert_position pos;
+  try {
+    pos = find_insert_pos(nd->key);
+  } catch (...) {
+    destroy_node(nd);
+    throw;
   }
 
-  return std::pair<iterator, bool>(it, res);
+  if (pos.existing) {
+    destroy_node(nd);
+    return std::pair<iterator, bool>(pos.existing, false);
+  }
+  return std::pair<iterator, bool>(link_node(nd, pos.parent, pos.left), true);
 }
 
-template <typename T>
-void rb_tree<T>::erase(iterator pos) {
-  node *replace, *delete_node = get_iter_node(pos), *tmp = nullptr;
-  if (!delete_node)
-    return;
-  else if (delete_node == root && !root->left && !root->right) {
-    delete delete_node;
-    root = nullptr;
+template <typename T, typename Compare, typename Weight>
+template <typename... Args>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::emplace_hint(iterator hint, Args &&...args) {
+  node *nd = create_node(std::forward<Args>(args)...);
+  insert_position pos;
+  try {
+    pos = find_hint_pos(get_iter_node(hint), nd->key);
+  } catch (...) {
+    destroy_node(nd);
+    throw;
+  }
+
+  if (pos.existing) {
+    destroy_node(nd);
+    return iterator(pos.existing);
+  }
+  return link_node(nd, pos.parent, pos.left);
+}
+
+// Relinks the node out of the tree, so the cost does not depend on the
+// element's size and iterators to the other elements stay valid.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::erase(iterator pos) {
+  node *nd = get_iter_node(pos);
+  if (!nd || nd->is_header) return;
+
+  unlink_node(nd);
+  destroy_node(nd);
+}
+
+template <typename T, typename Compare, typename Weight>
+inline void rb_tree<T, Compare, Weight>::swap(rb_tree &other) {
+  node *mine = root;
+  adopt_root(other.root);
+  other.adopt_root(mine);
+  std::swap(count_, other.count_);
+  pool_.swap(other.pool_);
+  borrowed_.swap(other.borrowed_);
+  std::swap(comp_, other.comp_);
+}
+
+// The nodes of other are spliced in rather than copied, so this tree
+// borrows the pools they live in first. The elements this tree already
+// has stay behind in other, which keeps the subtree they are left in.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::merge(rb_tree &other, unsigned threads) {
+  if (this == &other || other.root == nullptr) return;
+  int forks = fork_levels(threads, count_, other.count_);
+  borrow(other.pool_);
+  for (const auto &share : other.borrowed_) borrow(share);
+
+  combined res =
+      combine<set_op::unite>(detach(root), detach(other.root), forks);
+  size_type left_over = 0;
+  for_each_node(res.rest.root, [&left_over](node *) { left_over++; });
+
+  adopt_root(res.kept.root);
+  other.adopt_root(res.rest.root);
+  count_ += other.count_ - left_over;
+  other.count_ = left_over;
+}
+
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::intersect(rb_tree &other, unsigned threads) {
+  if (this == &other) return;
+  int forks = fork_levels(threads, count_, other.count_);
+
+  combined res =
+      combine<set_op::intersect>(detach(root), detach(other.root), forks);
+  adopt_root(res.kept.root);
+  other.adopt_root(res.rest.root);
+  for_each_node(res.dropped.root, [this](node *nd) {
+    destroy_node(nd);
     count_--;
+  });
+}
+
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::subtract(rb_tree &other, unsigned threads) {
+  if (this == &other) {
+    clear();
     return;
   }
-  if (delete_node->left && delete_node->right) {
-    replace = delete_node->right;
-    while (replace->left) replace = replace->left;
-    std::swap(delete_node->key, replace->key);
-  } else
-    replace = delete_node;
-
-  if (replace->right && !replace->left) {
-    replace->key = replace->right->key;
-    tmp = replace->right;
-    replace->right = nullptr;
-    delete tmp;
-  } else if (replace->left && !replace->right) {
-    replace->key = replace->left->key;
-    tmp = replace->left;
-    replace->left = nullptr;
-    delete tmp;
-  } else {
-    node *tmp_parent;
-    node_colors color = replace->color;
-    tmp = replace;
-    if (replace != root) {
-      if (replace->parent->left == replace) replace->parent->left = nullptr;
-      if (replace->parent->right == replace) replace->parent->right = nullptr;
+  int forks = fork_levels(threads, count_, other.count_);
+
+  combined res =
+      combine<set_op::subtract>(detach(root), detach(other.root), forks);
+  adopt_root(res.kept.root);
+  other.adopt_root(res.rest.root);
+  for_each_node(res.dropped.root, [this](node *nd) {
+    destroy_node(nd);
+    count_--;
+  });
+}
+
+// Set algebra on whole containers (set, map and anything else built on
+// rb_tree). The operands are taken by value: pass them with std::move to
+// reuse their nodes instead of copying them.
+template <typename Tree>
+using enable_if_rb_tree_t = std::enable_if_t<
+    std::is_base_of_v<
+        rb_tree<typename Tree::value_type, typename Tree::value_compare,
+                typename Tree::weight_type>,
+        Tree>,
+    Tree>;
+
+template <typename Tree>
+enable_if_rb_tree_t<Tree> set_union(Tree a, Tree b, unsigned threads = 1) {
+  a.merge(b, threads);
+  return a;
+}
+
+template <typename Tree>
+enable_if_rb_tree_t<Tree> set_intersection(Tree a, Tree b,
+                                           unsigned threads = 1) {
+  a.intersect(b, threads);
+  return a;
+}
+
+template <typename Tree>
+enable_if_rb_tree_t<Tree> set_difference(Tree a, Tree b,
+                                         unsigned threads = 1) {
+  a.subtract(b, threads);
+  return a;
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename InputIt>
+void rb_tree<T, Compare, Weight>::assign_sorted(InputIt first, InputIt last) {
+  using category = typename std::iterator_traits<InputIt>::iterator_category;
+
+  if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+    auto out_of_order = [this](const_reference a, const_reference b) {
+      return !comp_(a, b);
+    };
+    if (std::adjacent_find(first, last, out_of_order) == last) {
+      assign_unique_sorted(first, std::distance(first, last));
+      return;
     }
-    tmp_parent = replace->parent;
+  }
+  Vector<value_type> buf;
+  buf.insert(buf.end(), first, last);
+  assign_buffer(buf, false);
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::find(const_reference key) {
+  node *res = find_node(key);
+  return res ? iterator(res) : end();
+}
+
+template <typename T, typename Compare, typename Weight>
+bool rb_tree<T, Compare, Weight>::contains(const_reference key) {
+  return find_node(key) != nullptr;
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename K, typename C, typename>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::find(const K &key) {
+  node *res = find_node(key);
+  return res ? iterator(res) : end();
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename K, typename C, typename>
+bool rb_tree<T, Compare, Weight>::contains(const K &key) {
+  return find_node(key) != nullptr;
+}
+
+// Every lane holds one descent: the node it is about to compare with, the
+// last node it turned left at and where its result goes. A finished lane
+// is refilled with the next key of the block, or replaced by the last
+// active lane once the block runs dry.
+template <typename T, typename Compare, typename Weight>
+template <typename ForwardIt, typename OutputIt>
+OutputIt rb_tree<T, Compare, Weight>::find_many(ForwardIt first,
+                                                ForwardIt last, OutputIt out,
+                                                bool sort_batch) {
+  using key_type = typename std::iterator_traits<ForwardIt>::value_type;
+  struct lane {
+    node *cur;
+    node *candidate;
+    size_type slot;
+  };
 
-    delete tmp;
-    if (color == BLACK) balance_on_delete(tmp_parent, nullptr);
+  const key_type *keys[find_many_block];
+  size_type order[find_many_block];
+  node *found[find_many_block];
+  lane lanes[find_many_lanes];
+
+  while (first != last) {
+    size_type n = 0;
+    for (; first != last && n < find_many_block; ++first) {
+      keys[n] = &*first;
+      order[n] = n;
+      n++;
+    }
+    if constexpr (std::is_invocable_r_v<bool, const Compare &,
+                                        const key_type &, const key_type &>) {
+      if (sort_batch)
+        std::sort(order, order + n, [&](size_type a, size_type b) {
+          return comp_(*keys[a], *keys[b]);
+        });
+    }
+
+    size_type next = 0;
+    size_type active = 0;
+    while (active < find_many_lanes && next < n)
+      lanes[active++] = {root, nullptr, order[next++]};
+
+    while (active) {
+      for (size_type l = 0; l < active;) {
+        lane &ln = lanes[l];
+        if (ln.cur == nullptr) {
+          node *res = ln.candidate;
+          if (res && comp_(*keys[ln.slot], res->key)) res = nullptr;
+          found[ln.slot] = res;
+          if (next == n) {
+            ln = lanes[--active];
+            continue;
+          }
+          ln = {root, nullptr, order[next++]};
+          if (ln.cur == nullptr) continue;
+        }
+
+        if (!comp_(ln.cur->key, *keys[ln.slot])) {
+          ln.candidate = ln.cur;
+          ln.cur = ln.cur->left;
+        } else {
+          ln.cur = ln.cur->right;
+        }
+        if (ln.cur) __builtin_prefetch(ln.cur);
+        l++;
+      }
+    }
+
+    for (size_type i = 0; i < n; i++, ++out)
+      *out = found[i] ? iterator(found[i]) : end();
   }
-  count_--;
+  return out;
 }
 
-template <typename T>
-inline void rb_tree<T>::swap(rb_tree &other) {
-  std::swap(root, other.root);
-  std::swap(count_, other.count_);
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::lower_bound(const_reference key) {
+  node *res = lower_bound_node(key);
+  return res ? iterator(res) : end();
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::upper_bound(const_reference key) {
+  node *res = upper_bound_node(key);
+  return res ? iterator(res) : end();
+}
+
+template <typename T, typename Compare, typename Weight>
+std::pair<typename rb_tree<T, Compare, Weight>::iterator,
+          typename rb_tree<T, Compare, Weight>::iterator>
+rb_tree<T, Compare, Weight>::equal_range(const_reference key) {
+  return equal_range_of(key);
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename K, typename C, typename>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::lower_bound(const K &key) {
+  node *res = lower_bound_node(key);
+  return res ? iterator(res) : end();
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename K, typename C, typename>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::upper_bound(const K &key) {
+  node *res = upper_bound_node(key);
+  return res ? iterator(res) : end();
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename K, typename C, typename>
+std::pair<typename rb_tree<T, Compare, Weight>::iterator,
+          typename rb_tree<T, Compare, Weight>::iterator>
+rb_tree<T, Compare, Weight>::equal_range(const K &key) {
+  return equal_range_of(key);
 }
 
-template <typename T>
-void rb_tree<T>::merge(rb_tree &other) {
-  for (auto it = other.begin(); it != other.end(); it++) insert(*it);
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::nth(size_type k) {
+  static_assert(order_statistics, "nth() needs a tree with a Weight");
+  node *cur = root;
+
+  while (cur) {
+    size_type left = subtree_weight(cur->left);
+    size_type own = Weight()(cur->key);
+    if (k < left) {
+      cur = cur->left;
+    } else if (k < left + own) {
+      return iterator(cur);
+    } else {
+      k -= left + own;
+      cur = cur->right;
+    }
+  }
+  return end();
 }
 
-template <typename T>
-typename rb_tree<T>::iterator rb_tree<T>::find(const_reference key) {
-  return iterator(find(root, key));
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::size_type
+rb_tree<T, Compare, Weight>::rank(const_reference key) {
+  return rank_of(key);
 }
 
-template <typename T>
-bool rb_tree<T>::contains(const_reference key) {
-  return find(key) != end();
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::size_type
+rb_tree<T, Compare, Weight>::count_range(const_reference lo,
+                                         const_reference hi) {
+  return count_range_of(lo, hi);
 }
 
 // rb_tree::iterator
 
 // public rb_tree::iterator
 
-template <typename T>
-rb_tree<T>::iterator::iterator() : iter_node(nullptr) {}
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::iterator::iterator() : iter_node(nullptr) {}
 
-template <typename T>
-rb_tree<T>::iterator::iterator(const iterator &other) {
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::iterator::iterator(const iterator &other) {
   this->iter_node = other.iter_node;
 }
 
-template <typename T>
-inline typename rb_tree<T>::reference rb_tree<T>::iterator::operator*() const {
-  if (!iter_node) throw std::runtime_error("Error: Operator* for nullptr");
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::reference
+rb_tree<T, Compare, Weight>::iterator::operator*() const {
+  if (!iter_node || iter_node->is_header)
+    throw std::runtime_error("Error: Operator* for end()");
   return iter_node->key;
 }
 
-template <typename T>
-inline bool rb_tree<T>::iterator::operator==(const iterator &other) const {
+template <typename T, typename Compare, typename Weight>
+inline bool rb_tree<T, Compare, Weight>::iterator::operator==(
+    const iterator &other) const {
   return iter_node == other.iter_node;
 }
 
-template <typename T>
-inline bool rb_tree<T>::iterator::operator!=(const iterator &other) const {
+template <typename T, typename Compare, typename Weight>
+inline bool rb_tree<T, Compare, Weight>::iterator::operator!=(
+    const iterator &other) const {
   return iter_node != other.iter_node;
 }
 
-template <typename T>
-inline typename rb_tree<T>::iterator &rb_tree<T>::iterator::operator++() {
-  iter_node = next(iter_node);
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::iterator &
+rb_tree<T, Compare, Weight>::iterator::operator++() {
+  iter_node = successor(iter_node);
+
+  return *this;
+}
+
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::iterator::operator++(int) {
+  rb_tree<T, Compare, Weight>::iterator tmp(*this);
+  iter_node = successor(tmp.iter_node);
+
+  return tmp;
+}
+
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::iterator &
+rb_tree<T, Compare, Weight>::iterator::operator--() {
+  iter_node = predecessor(iter_node);
 
   return *this;
 }
 
-template <typename T>
-inline typename rb_tree<T>::iterator rb_tree<T>::iterator::operator++(int) {
-  rb_tree<T>::iterator tmp(*this);
-  iter_node = next(tmp.iter_node);
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::iterator::operator--(int) {
+  rb_tree<T, Compare, Weight>::iterator tmp(*this);
+  iter_node = predecessor(tmp.iter_node);
 
   return tmp;
 }
 
-template <typename T>
-typename rb_tree<T>::iterator &rb_tree<T>::iterator::operator=(
-    const iterator &other) {
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator &
+rb_tree<T, Compare, Weight>::iterator::operator=(const iterator &other) {
   iter_node = other.iter_node;
   return *this;
 }
 
 // protected rb_tree::iterator
 
-template <typename T>
-inline rb_tree<T>::iterator::iterator(node *nd) : iter_node(nd) {}
+template <typename T, typename Compare, typename Weight>
+inline rb_tree<T, Compare, Weight>::iterator::iterator(node *nd)
+    : iter_node(nd) {}
 
-// private rb_tree::iterator
+// rb_tree::const_iterator
 
-template <typename T>
-typename rb_tree<T>::node *rb_tree<T>::iterator::next(node *nd) {
-  if (nd == nullptr) return nullptr;
-  if (nd->right) {
-    nd = nd->right;
-    while (nd->left) nd = nd->left;
-  } else {
-    node *parent = nd->parent;
-    while (parent && nd == parent->right) {
-      nd = parent;
-      parent = parent->parent;
+// public rb_tree::const_iterator
+
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::const_reference
+rb_tree<T, Compare, Weight>::const_iterator::operator*() const {
+  if (!this->iter_node || this->iter_node->is_header)
+    throw std::runtime_error("Error: Operator* for end()");
+  return this->iter_node->key;
+}
+
+// rb_tree::node_type
+
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::node_type::node_type(node_type &&other) noexcept
+    : nd_(other.nd_), pool_(std::move(other.pool_)) {
+  other.nd_ = nullptr;
+}
+
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::node_type::~node_type() {
+  reset();
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node_type &
+rb_tree<T, Compare, Weight>::node_type::operator=(node_type &&other) noexcept {
+  if (this != &other) {
+    reset();
+    std::swap(nd_, other.nd_);
+    std::swap(pool_, other.pool_);
+  }
+  return *this;
+}
+
+template <typename T, typename Compare, typename Weight>
+inline bool rb_tree<T, Compare, Weight>::node_type::empty() const {
+  return nd_ == nullptr;
+}
+
+template <typename T, typename Compare, typename Weight>
+inline rb_tree<T, Compare, Weight>::node_type::operator bool() const {
+  return nd_ != nullptr;
+}
+
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::reference
+rb_tree<T, Compare, Weight>::node_type::value() const {
+  return nd_->key;
+}
+
+template <typename T, typename Compare, typename Weight>
+rb_tree<T, Compare, Weight>::node_type::node_type(
+    node *nd, std::shared_ptr<shared_pool> pool)
+    : nd_(nd), pool_(std::move(pool)) {}
+
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::node_type::reset() {
+  if (nd_) {
+    nd_->~node();
+    pool_->give_back(nd_);
+    nd_ = nullptr;
+    pool_.reset();
+  }
+}
+
+// private rb_tree
+
+// Lower-bound descent with a single comparison per level; the candidate it
+// ends on only needs the reverse comparison to confirm equivalence.
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::find_node(const K &key) {
+  node *candidate = lower_bound_node(key);
+
+  if (candidate && comp_(key, candidate->key)) candidate = nullptr;
+  return candidate;
+}
+
+// The last node the descent turns left at is the lowest one not ordered
+// before key; null when there is none.
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::lower_bound_node(const K &key) {
+  node *cur = root;
+  node *candidate = nullptr;
+
+  while (cur) {
+    if (!comp_(cur->key, key)) {
+      candidate = cur;
+      cur = cur->left;
+    } else {
+      cur = cur->right;
     }
+  }
+  return candidate;
+}
 
-    nd = parent;
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::upper_bound_node(const K &key) {
+  node *cur = root;
+  node *candidate = nullptr;
+
+  while (cur) {
+    if (comp_(key, cur->key)) {
+      candidate = cur;
+      cur = cur->left;
+    } else {
+      cur = cur->right;
+    }
+  }
+  return candidate;
+}
+
+// Keys are unique, so the range holds the lower bound alone if that one is
+// equivalent to key, and is empty otherwise.
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+std::pair<typename rb_tree<T, Compare, Weight>::iterator,
+          typename rb_tree<T, Compare, Weight>::iterator>
+rb_tree<T, Compare, Weight>::equal_range_of(const K &key) {
+  node *lo = lower_bound_node(key);
+  if (lo == nullptr) return {end(), end()};
+  if (comp_(key, lo->key)) return {iterator(lo), iterator(lo)};
+  return {iterator(lo), iterator(successor(lo))};
+}
+
+// Same single-comparison descent for insertion. An equivalent key can only
+// be the in-order predecessor of the slot the descent ends in. A key past
+// the maximum, as with sorted input, goes right of it without a descent.
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::insert_position
+rb_tree<T, Compare, Weight>::find_insert_pos(const K &key) {
+  if (root && comp_(header_.right->key, key))
+    return {header_.right, false, nullptr};
+  return find_insert_pos_in(root, key);
+}
+
+// Descends from top, whose subtree must span the gap key belongs in.
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::insert_position
+rb_tree<T, Compare, Weight>::find_insert_pos_in(node *top, const K &key) {
+  node *cur = top;
+  node *parent = nullptr;
+  bool left = true;
+
+  while (cur) {
+    parent = cur;
+    left = comp_(key, cur->key);
+    cur = left ? cur->left : cur->right;
+  }
+
+  node *prev = parent;
+  if (parent && left)
+    prev = parent == header_.left ? nullptr : predecessor(parent);
+  if (prev && !comp_(prev->key, key)) return {prev, false, prev};
+  return {parent, left, nullptr};
+}
+
+// Tries the slots next to hint before falling back to a full descent. The
+// neighbour looked at is found in amortized constant time when the hints
+// walk through the tree in order.
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::insert_position
+rb_tree<T, Compare, Weight>::find_hint_pos(node *hint, const K &key) {
+  if (hint == nullptr || hint->is_header || root == nullptr)
+    return find_insert_pos(key);
+
+  if (comp_(key, hint->key)) {
+    if (hint == header_.left) return {hint, true, nullptr};
+    node *before = predecessor(hint);
+    if (comp_(before->key, key)) {
+      if (before->right == nullptr) return {before, false, nullptr};
+      return {hint, true, nullptr};
+    }
+    return find_insert_pos(key);
   }
+  if (comp_(hint->key, key)) {
+    if (hint == header_.right) return {hint, false, nullptr};
+    node *after = successor(hint);
+    if (comp_(key, after->key)) {
+      if (hint->right == nullptr) return {hint, false, nullptr};
+      return {after, true, nullptr};
+    }
+    return find_insert_pos(key);
+  }
+  return {hint, false, hint};
+}
+
+// prev is ordered before key or equivalent to it, e.g. the node an
+// ascending batch placed last. The lowest ancestor of prev with key in its
+// left subtree bounds the gap key goes in, so the search climbs to the
+// child on that side and descends from there: O(1) amortized when the
+// batch is dense in the tree and O(log gap) otherwise.
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::insert_position
+rb_tree<T, Compare, Weight>::find_pos_after(node *prev, const K &key) {
+  if (prev == nullptr) return find_insert_pos(key);
+  if (!comp_(prev->key, key)) return {prev, false, prev};
+  if (comp_(header_.right->key, key)) return {header_.right, false, nullptr};
+
+  node *top = prev;
+  while (top != root) {
+    node *parent = top->parent;
+    if (parent->left == top && comp_(key, parent->key)) break;
+    top = parent;
+  }
+  return find_insert_pos_in(top, key);
+}
+
+// Sums the weight of every subtree the descent for key leaves on its left.
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::size_type
+rb_tree<T, Compare, Weight>::rank_of(const K &key) {
+  static_assert(order_statistics, "rank() needs a tree with a Weight");
+  node *cur = root;
+  size_type res = 0;
+
+  while (cur) {
+    if (comp_(cur->key, key)) {
+      res += cur->weight - subtree_weight(cur->right);
+      cur = cur->right;
+    } else {
+      cur = cur->left;
+    }
+  }
+  return res;
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename K>
+typename rb_tree<T, Compare, Weight>::size_type
+rb_tree<T, Compare, Weight>::count_range_of(const K &lo, const K &hi) {
+  size_type below_lo = rank_of(lo);
+  size_type below_hi = rank_of(hi);
+  return below_hi > below_lo ? below_hi - below_lo : 0;
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename... Args>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::insert_at(
+    const insert_position &pos, Args &&...args) {
+  return link_node(create_node(std::forward<Args>(args)...), pos.parent,
+                   pos.left);
+}
+
+// Builds the tree from n strictly increasing elements, allocating the
+// nodes in order. Splitting every range in half keeps all null children
+// within one level of each other, so colouring the nodes below the last
+// complete level red gives every path the same black height.
+template <typename T, typename Compare, typename Weight>
+template <typename It>
+void rb_tree<T, Compare, Weight>::assign_unique_sorted(It first, size_type n) {
+  size_type complete_levels = 0;
+  while ((size_type(1) << (complete_levels + 1)) <= n + 1) complete_levels++;
+
+  clear();
+  adopt_root(build_sorted(first, n, 0, complete_levels));
+  count_ = n;
+}
+
+template <typename T, typename Compare, typename Weight>
+template <typename It>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::build_sorted(
+    It &it, size_type n, size_type depth, size_type red_depth) {
+  if (n == 0) return nullptr;
+
+  node *left = build_sorted(it, n / 2, depth + 1, red_depth);
+  node *nd = create_node(*it);
+  ++it;
+  nd->color = depth == red_depth ? RED : BLACK;
+  nd->left = left;
+  if (left) left->parent = nd;
+  nd->right = build_sorted(it, n - n / 2 - 1, depth + 1, red_depth);
+  if (nd->right) nd->right->parent = nd;
+  update_weight(nd);
 
   return nd;
 }
 
-// rb_tree::const_iterator
+// Sorts buf unless it already is, drops equivalent elements (keeping the
+// first or the last of each run) and builds the tree from what is left.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::assign_buffer(Vector<value_type> &buf,
+                                                bool keep_last) {
+  if (!std::is_sorted(buf.begin(), buf.end(), comp_))
+    std::stable_sort(buf.begin(), buf.end(), comp_);
+
+  size_type n = 0;
+  for (size_type i = 0; i < buf.size(); i++) {
+    if (n > 0 && !comp_(buf[n - 1], buf[i])) {
+      if (keep_last) buf[n - 1] = std::move(buf[i]);
+    } else {
+      if (n != i) buf[n] = std::move(buf[i]);
+      n++;
+    }
+  }
+  assign_unique_sorted(std::make_move_iterator(buf.begin()), n);
+}
 
-// public rb_tree::const_iterator
+template <typename T, typename Compare, typename Weight>
+template <typename... Args>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::create_node(Args &&...args) {
+  shared_pool &own = pool();
+  if (own.returned.load(std::memory_order_relaxed)) own.reclaim();
+  void *mem = own.nodes.allocate();
+  try {
+    node *nd = new (mem) node(std::forward<Args>(args)...);
+    nd->owner = &own;
+    return nd;
+  } catch (...) {
+    own.nodes.deallocate(mem);
+    throw;
+  }
+}
 
-template <typename T>
-inline typename rb_tree<T>::const_reference
-rb_tree<T>::const_iterator::operator*() const {
-  if (!this->iter_node)
-    throw std::runtime_error("Error: Operator* for nullptr");
-  return this->iter_node->key;
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::destroy_node(node *nd) {
+  shared_pool *owner = nd->owner;
+  nd->~node();
+  if (owner == pool_.get())
+    owner->nodes.deallocate(nd);
+  else
+    owner->give_back(nd);
 }
 
-// private rb_tree
+// A moved-from tree has no pool until it needs one again.
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::shared_pool &
+rb_tree<T, Compare, Weight>::pool() {
+  if (!pool_) pool_ = std::make_shared<shared_pool>();
+  return *pool_;
+}
+
+// The pool nd lives in, which is either this tree's or a borrowed one.
+template <typename T, typename Compare, typename Weight>
+std::shared_ptr<typename rb_tree<T, Compare, Weight>::shared_pool>
+rb_tree<T, Compare, Weight>::share_of(const node *nd) {
+  if (nd->owner == pool_.get()) return pool_;
+  for (const auto &share : borrowed_)
+    if (share.get() == nd->owner) return share;
+  return nullptr;
+}
+
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::borrow(
+    const std::shared_ptr<shared_pool> &share) {
+  if (!share || share == pool_) return;
+  for (const auto &held : borrowed_)
+    if (held == share) return;
+  borrowed_.push_back(share);
+}
+
+// Safe from any thread: the node is pushed onto returned without a lock.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::shared_pool::give_back(node *nd) noexcept {
+  returned_node *head = new (static_cast<void *>(nd))
+      returned_node{returned.load(std::memory_order_relaxed)};
+  while (!returned.compare_exchange_weak(head->next, head,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+  }
+}
 
-template <typename T>
-typename rb_tree<T>::node *rb_tree<T>::copy(node *nd, node *parent) {
+// Moves everything given back so far to the free list of nodes. Only the
+// owning tree calls this.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::shared_pool::reclaim() noexcept {
+  returned_node *head = returned.exchange(nullptr, std::memory_order_acquire);
+  while (head) {
+    returned_node *next = head->next;
+    nodes.deallocate(head);
+    head = next;
+  }
+}
+
+// Taking returned with acquire orders the chunks' release after whatever
+// the trees that gave nodes back did to them.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::shared_pool::release() noexcept {
+  returned.exchange(nullptr, std::memory_order_acquire);
+  nodes.release();
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node *rb_tree<T, Compare, Weight>::copy(
+    node *nd, node *parent) {
   if (nd == nullptr) return nullptr;
-  node *tmp = new node(nd->key, parent, nd->color);
+  node *tmp = create_node(nd->key);
+  tmp->parent = parent;
+  tmp->color = nd->color;
   tmp->left = copy(nd->left, tmp);
   tmp->right = copy(nd->right, tmp);
+  update_weight(tmp);
 
   return tmp;
 }
 
-template <typename T>
-void rb_tree<T>::free_node(node *nd) {
-  if (nd == nullptr) return;
-  free_node(nd->left);
-  free_node(nd->right);
+// Unless a handle or another tree still holds the pool, or some nodes came
+// from other pools, only the payload destructors have to run before the
+// chunks are handed back in one go. Otherwise every node goes back to its
+// pool one by one. The tree is flattened by right rotations on the way to
+// avoid recursion.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::free_tree() {
+  shared_pool *own = pool_.get();
+  bool shared = own && pool_.use_count() > 1;
+
+  if (shared || !borrowed_.empty() ||
+      !std::is_trivially_destructible_v<value_type>) {
+    node *nd = root;
+    while (nd) {
+      if (nd->left) {
+        node *left = nd->left;
+        nd->left = left->right;
+        left->right = nd;
+        nd = left;
+      } else {
+        node *next = nd->right;
+        shared_pool *owner = nd->owner;
+        nd->~node();
+        if (owner != own)
+          owner->give_back(nd);
+        else if (shared)
+          own->nodes.deallocate(nd);
+        nd = next;
+      }
+    }
+  }
+  if (own && !shared) own->release();
+  borrowed_.clear();
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::successor(node *nd) {
+  if (nd == nullptr || nd->is_header) return nd;
+  if (nd->right) {
+    nd = nd->right;
+    while (nd->left) nd = nd->left;
+  } else {
+    node *parent = nd->parent;
+    while (!parent->is_header && nd == parent->right) {
+      nd = parent;
+      parent = parent->parent;
+    }
+
+    nd = parent;
+  }
 
-  delete nd;
+  return nd;
 }
 
-template <typename T>
-typename rb_tree<T>::node *rb_tree<T>::find(node *root, const_reference key) {
-  if (root == nullptr) return nullptr;
-  node *res = nullptr;
-  if (root->key == key)
-    res = root;
-  else if (root->key < key)
-    res = find(root->right, key);
-  else
-    res = find(root->left, key);
-  return res;
+// Stepping back from end() lands on the rightmost node cached in the
+// header.
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::predecessor(node *nd) {
+  if (nd == nullptr) return nullptr;
+  if (nd->is_header) return nd->right;
+  if (nd->left) {
+    nd = nd->left;
+    while (nd->right) nd = nd->right;
+  } else {
+    node *parent = nd->parent;
+    while (!parent->is_header && nd == parent->left) {
+      nd = parent;
+      parent = parent->parent;
+    }
+
+    nd = parent;
+  }
+
+  return nd;
 }
 
-template <typename T>
-void rb_tree<T>::left_rotate(node *x) {
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::left_rotate(node *x) {
   node *y = x->right;
   x->right = y->left;
 
   if (y->left) y->left->parent = x;
   y->parent = x->parent;
 
-  if (x->parent == nullptr)
+  if (x == root)
     root = y;
   else {
     if (x == x->parent->left)
@@ -423,17 +1577,19 @@ void rb_tree<T>::left_rotate(node *x) {
 
   y->left = x;
   x->parent = y;
+  update_weight(x);
+  update_weight(y);
 }
 
-template <typename T>
-void rb_tree<T>::right_rotate(node *y) {
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::right_rotate(node *y) {
   node *x = y->left;
   y->left = x->right;
 
   if (x->right) x->right->parent = y;
   x->parent = y->parent;
 
-  if (y->parent == nullptr)
+  if (y == root)
     root = x;
   else {
     if (y == y->parent->right)
@@ -444,10 +1600,13 @@ void rb_tree<T>::right_rotate(node *y) {
 
   x->right = y;
   y->parent = x;
+  update_weight(y);
+  update_weight(x);
 }
 
-template <typename T>
-typename rb_tree<T>::iterator rb_tree<T>::balance_on_insert(node *nd) {
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::balance_on_insert(node *nd) {
   bool stop = false;
   node *parent = nd->parent;
   while (nd != this->root && parent->color == RED && !stop) {
@@ -494,148 +1653,444 @@ typename rb_tree<T>::iterator rb_tree<T>::balance_on_insert(node *nd) {
   return iterator(nd);
 }
 
-template <typename T>
-void rb_tree<T>::balance_on_delete_black_pair_left(node *parent, node *child) {
-  child = parent->left;
-  if (child->color == RED) {
-    node *gr_son = child->right;
-    if ((gr_son && gr_son->left && gr_son->left->color == RED) ||
-        (gr_son && gr_son->right && gr_son->right->color == RED)) {
-      if (gr_son->left) {
-        gr_son->left->color = BLACK;
-        left_rotate(child);
-        right_rotate(parent);
-      } else if (gr_son->right) {
-        parent->left->color = BLACK;
-        gr_son->color = BLACK;
-        gr_son->right->color = RED;
-        parent->color = BLACK;
-        right_rotate(parent);
-        left_rotate(gr_son);
-        right_rotate(parent);
-      }
-    } else if (gr_son && ((!gr_son->left && !gr_son->right) ||
-                          (gr_son->left->color == BLACK &&
-                           gr_son->right->color == BLACK))) {
-      gr_son->color = RED;
-      child->color = BLACK;
-      right_rotate(parent);
-    }
+template <typename T, typename Compare, typename Weight>
+inline typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::get_iter_node(iterator it) {
+  return it.iter_node;
+}
+
+// Hangs the fresh node nd under parent (or makes it the root when parent
+// is null), keeps the header's extremes up to date and rebalances.
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::iterator
+rb_tree<T, Compare, Weight>::link_node(node *nd, node *parent, bool left) {
+  count_++;
+  nd->parent = parent;
+  nd->color = RED;
+  if (parent == nullptr) {
+    root = nd;
+    nd->parent = &header_;
+    header_.left = header_.right = nd;
+  } else if (left) {
+    parent->left = nd;
+    if (parent == header_.left) header_.left = nd;
   } else {
-    if (child->right && child->right->color == RED) {
-      child->right->color = BLACK;
-      left_rotate(child);
-      right_rotate(parent);
-    } else if (child->left && child->left->color == RED) {
-      child->left->color = BLACK;
-      right_rotate(parent);
-    } else if ((!child->left && !child->right) ||
-               (child->left->color == BLACK && child->right->color == BLACK)) {
-      child->color = RED;
-      balance_on_delete(parent->parent, parent);
+    parent->right = nd;
+    if (parent == header_.right) header_.right = nd;
+  }
+  refresh_weights(nd);
+  balance_on_insert(nd);
+  return iterator(nd);
+}
+
+// Takes nd out of the tree by relinking, so iterators to every other node
+// stay valid and no element is moved. A node with two children trades
+// places with its successor first. nd's own links are left as they were.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::unlink_node(node *nd) {
+  if (header_.left == nd) header_.left = successor(nd);
+  if (header_.right == nd) header_.right = predecessor(nd);
+
+  node_colors removed_color = nd->color;
+  node *x, *x_parent;
+  if (nd->left == nullptr) {
+    x = nd->right;
+    x_parent = nd->parent;
+    transplant(nd, nd->right);
+  } else if (nd->right == nullptr) {
+    x = nd->left;
+    x_parent = nd->parent;
+    transplant(nd, nd->left);
+  } else {
+    node *next = nd->right;
+    while (next->left) next = next->left;
+    removed_color = next->color;
+    x = next->right;
+    if (next->parent == nd) {
+      x_parent = next;
+    } else {
+      x_parent = next->parent;
+      transplant(next, next->right);
+      next->right = nd->right;
+      next->right->parent = next;
     }
+    transplant(nd, next);
+    next->left = nd->left;
+    next->left->parent = next;
+    next->color = nd->color;
   }
+
+  count_--;
+  refresh_weights(x_parent);
+  if (removed_color == BLACK) balance_after_unlink(x, x_parent);
+}
+
+// Puts new_child (possibly null) where old_child hangs, the root included.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::transplant(node *old_child,
+                                             node *new_child) {
+  if (old_child == root)
+    root = new_child;
+  else if (old_child == old_child->parent->left)
+    old_child->parent->left = new_child;
+  else
+    old_child->parent->right = new_child;
+  if (new_child) new_child->parent = old_child->parent;
 }
 
-template <typename T>
-void rb_tree<T>::balance_on_delete_black_pair_right(node *parent, node *child) {
-  child = parent->right;
-  if (child->color == RED) {
-    node *gr_son = child->left;
-    if ((gr_son && gr_son->right && gr_son->right->color == RED) ||
-        (gr_son && gr_son->left && gr_son->left->color == RED)) {
-      if (gr_son->right) {
-        gr_son->right->color = BLACK;
-        right_rotate(child);
+// The textbook delete fixup. x, possibly null, sits below parent and its
+// paths are one black node short; the sibling's subtree lends one, or the
+// deficit moves up a level.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::balance_after_unlink(node *x,
+                                                       node *parent) {
+  while (x != root && is_black(x)) {
+    if (x == parent->left) {
+      node *sibling = parent->right;
+      if (sibling->color == RED) {
+        sibling->color = BLACK;
+        parent->color = RED;
         left_rotate(parent);
-      } else if (gr_son->left) {
-        parent->right->color = BLACK;
-        gr_son->color = BLACK;
-        gr_son->left->color = RED;
+        sibling = parent->right;
+      }
+      if (is_black(sibling->left) && is_black(sibling->right)) {
+        sibling->color = RED;
+        x = parent;
+        parent = x->parent;
+      } else {
+        if (is_black(sibling->right)) {
+          sibling->left->color = BLACK;
+          sibling->color = RED;
+          right_rotate(sibling);
+          sibling = parent->right;
+        }
+        sibling->color = parent->color;
         parent->color = BLACK;
+        sibling->right->color = BLACK;
         left_rotate(parent);
-        right_rotate(gr_son);
-        left_rotate(parent);
+        x = root;
+      }
+    } else {
+      node *sibling = parent->left;
+      if (sibling->color == RED) {
+        sibling->color = BLACK;
+        parent->color = RED;
+        right_rotate(parent);
+        sibling = parent->left;
+      }
+      if (is_black(sibling->left) && is_black(sibling->right)) {
+        sibling->color = RED;
+        x = parent;
+        parent = x->parent;
+      } else {
+        if (is_black(sibling->left)) {
+          sibling->right->color = BLACK;
+          sibling->color = RED;
+          left_rotate(sibling);
+          sibling = parent->left;
+        }
+        sibling->color = parent->color;
+        parent->color = BLACK;
+        sibling->left->color = BLACK;
+        right_rotate(parent);
+        x = root;
       }
-    } else if (gr_son && ((!gr_son->left && !gr_son->right) ||
-                          (gr_son->left->color == BLACK &&
-                           gr_son->right->color == BLACK))) {
-      gr_son->color = RED;
-      child->color = BLACK;
-      left_rotate(parent);
-    }
-  } else {
-    if (child->left && child->left->color == RED) {
-      child->left->color = BLACK;
-      right_rotate(child);
-      left_rotate(parent);
-    } else if (child->right && child->right->color == RED) {
-      child->right->color = BLACK;
-      left_rotate(parent);
-    } else if ((!child->left && !child->right) ||
-               (child->left->color == BLACK && child->right->color == BLACK)) {
-      child->color = RED;
-      balance_on_delete(parent->parent, parent);
     }
   }
+  if (x) x->color = BLACK;
 }
 
-template <typename T>
-void rb_tree<T>::balance_on_delete_red_par(node *parent, node *prev) {
-  node *child;
-  if (parent->left && (!parent->right || parent->right == prev)) {
-    child = parent->left;
-    if (child->right && child->right->color == RED) {
-      parent->color = BLACK;
-      left_rotate(child);
-      right_rotate(parent);
-    } else if (child && child->left && child->left->color == RED) {
-      parent->color = BLACK;
-      child->color = RED;
-      child->left->color = BLACK;
-      right_rotate(parent);
-    } else if ((!child->left && !child->right) ||
-               (child->left->color == BLACK && child->right->color == BLACK)) {
-      parent->color = BLACK;
-      child->color = RED;
-    }
-  } else if (parent->right && (!parent->left || parent->left == prev)) {
-    child = parent->right;
-    if (child->right && child->right->color == RED) {
-      parent->color = BLACK;
-      child->color = RED;
-      child->right->color = BLACK;
-      left_rotate(parent);
-    } else if (child->left && child->left->color == RED) {
-      parent->color = BLACK;
-      right_rotate(child);
-      left_rotate(parent);
-    } else if ((!child->left && !child->right) ||
-               (child->left->color == BLACK && child->right->color == BLACK)) {
-      parent->color = BLACK;
-      child->color = RED;
-    }
+template <typename T, typename Compare, typename Weight>
+inline bool rb_tree<T, Compare, Weight>::is_black(const node *nd) {
+  return nd == nullptr || nd->color == BLACK;
+}
+
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::reset_header() {
+  root = nullptr;
+  header_.left = header_.right = &header_;
+}
+
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::adopt_root(node *new_root) {
+  if (new_root == nullptr) {
+    reset_header();
+    return;
   }
+  root = new_root;
+  root->parent = &header_;
+  node *nd = root;
+  while (nd->left) nd = nd->left;
+  header_.left = nd;
+  nd = root;
+  while (nd->right) nd = nd->right;
+  header_.right = nd;
 }
 
-template <typename T>
-void rb_tree<T>::balance_on_delete(node *parent, node *prev) {
-  if (parent == nullptr) return;
-  node *child = nullptr;
-  if (parent->color == RED) {
-    balance_on_delete_red_par(parent, prev);
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::size_type
+rb_tree<T, Compare, Weight>::subtree_weight(const node *nd) {
+  if constexpr (order_statistics)
+    return nd ? nd->weight : 0;
+  else
+    return 0;
+}
+
+// Recomputes the cached weight of nd from its children, which must be up
+// to date. Rotations and joins call this for every node they move.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::update_weight(node *nd) {
+  if constexpr (order_statistics)
+    nd->weight = Weight()(nd->key) + subtree_weight(nd->left) +
+                 subtree_weight(nd->right);
+}
+
+// Brings the weights from nd up to the root up to date after nd's own
+// weight or its children changed.
+template <typename T, typename Compare, typename Weight>
+void rb_tree<T, Compare, Weight>::refresh_weights(node *nd) {
+  if constexpr (order_statistics)
+    for (; nd && !nd->is_header; nd = nd->parent) update_weight(nd);
+}
+
+// Join-based set operations. All of them work on detached subtrees: the
+// root's parent is null and the root may be red. Every subtree handed
+// around is a valid red-black tree otherwise.
+
+// Splits t1 at its root, splits t2 around the root's key and combines the
+// halves recursively, the two recursive calls on separate threads while
+// forks lasts. Only links are rewritten, so the threads never touch the
+// pool.
+template <typename T, typename Compare, typename Weight>
+template <typename rb_tree<T, Compare, Weight>::set_op Op>
+typename rb_tree<T, Compare, Weight>::combined
+rb_tree<T, Compare, Weight>::combine(subtree t1, subtree t2, int forks) {
+  if (t1.root == nullptr) {
+    if (Op == set_op::unite) return {t2, {}, {}};
+    return {{}, t2, {}};
+  }
+  if (t2.root == nullptr) {
+    if (Op == set_op::intersect) return {{}, {}, t1};
+    return {t1, {}, {}};
+  }
+
+  node *mid = t1.root;
+  subtree l1 = detach_child(mid->left, t1.height);
+  subtree r1 = detach_child(mid->right, t1.height);
+  split_parts parts = split(t2, mid->key);
+  combined lo, hi;
+  if (forks > 0) {
+    auto task = std::async(std::launch::async, [&] {
+      return combine<Op>(l1, parts.left, forks - 1);
+    });
+    hi = combine<Op>(r1, parts.right, forks - 1);
+    lo = task.get();
   } else {
-    if (parent->left && (!parent->right || parent->right == prev)) {
-      balance_on_delete_black_pair_left(parent, child);
-    } else if (parent->right && (!parent->left || parent->left == prev)) {
-      balance_on_delete_black_pair_right(parent, child);
-    }
+    lo = combine<Op>(l1, parts.left, 0);
+    hi = combine<Op>(r1, parts.right, 0);
+  }
+
+  combined res;
+  if (parts.match)
+    res.rest = join(lo.rest, parts.match, hi.rest);
+  else
+    res.rest = join2(lo.rest, hi.rest);
+  bool keep = Op == set_op::unite ||
+              (Op == set_op::intersect) == (parts.match != nullptr);
+  if (keep) {
+    res.kept = join(lo.kept, mid, hi.kept);
+    res.dropped = join2(lo.dropped, hi.dropped);
+  } else {
+    res.kept = join2(lo.kept, hi.kept);
+    res.dropped = join(lo.dropped, mid, hi.dropped);
   }
+  return res;
 }
 
-template <typename T>
-inline typename rb_tree<T>::node *rb_tree<T>::get_iter_node(iterator it) {
-  return it.iter_node;
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::split_parts
+rb_tree<T, Compare, Weight>::split(subtree t, const_reference key) {
+  if (t.root == nullptr) return {{}, nullptr, {}};
+
+  node *nd = t.root;
+  subtree left = detach_child(nd->left, t.height);
+  subtree right = detach_child(nd->right, t.height);
+  if (comp_(key, nd->key)) {
+    split_parts parts = split(left, key);
+    parts.right = join(parts.right, nd, right);
+    return parts;
+  }
+  if (comp_(nd->key, key)) {
+    split_parts parts = split(right, key);
+    parts.left = join(left, nd, parts.left);
+    return parts;
+  }
+  return {left, nd, right};
+}
+
+// Joins left, the single node mid and right, every key of left ordering
+// before mid and every key of right after it. The shorter tree is hung
+// off the spine of the taller one where the black heights meet, which
+// costs time proportional to their difference. The result is one taller
+// than its taller operand exactly when its root had to be painted black.
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::subtree
+rb_tree<T, Compare, Weight>::join(subtree left, node *mid, subtree right) {
+  if (left.root) left.root->color = BLACK;
+  if (right.root) right.root->color = BLACK;
+  node *t;
+
+  if (left.height > right.height)
+    t = join_right(left.root, left.height, mid, right.root, right.height);
+  else if (right.height > left.height)
+    t = join_left(right.root, right.height, mid, left.root, left.height);
+  else
+    t = attach(mid, left.root, right.root, RED);
+
+  size_type height = std::max(left.height, right.height);
+  if (t->color == RED) height++;
+  t->parent = nullptr;
+  t->color = BLACK;
+  return {t, height};
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::subtree
+rb_tree<T, Compare, Weight>::join2(subtree left, subtree right) {
+  if (left.root == nullptr) return right;
+  if (right.root == nullptr) return left;
+  node *last;
+  left = split_last(left, last);
+  return join(left, last, right);
+}
+
+// Walks down the right spine of t, of black height height, to the first
+// black node as high as right and puts mid there. A red-red pair this may
+// leave under a black node is fixed by a left rotation on the way up.
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::join_right(node *t, size_type height, node *mid,
+                                        node *right, size_type right_height) {
+  if ((t == nullptr || t->color == BLACK) && height == right_height)
+    return attach(mid, t, right, RED);
+
+  size_type child_height = t->color == BLACK ? height - 1 : height;
+  node *c = join_right(t->right, child_height, mid, right, right_height);
+  t->right = c;
+  c->parent = t;
+  if (t->color == BLACK && c->color == RED && c->right &&
+      c->right->color == RED) {
+    c->right->color = BLACK;
+    t->right = c->left;
+    if (c->left) c->left->parent = t;
+    c->left = t;
+    t->parent = c;
+    update_weight(t);
+    update_weight(c);
+    return c;
+  }
+  update_weight(t);
+  return t;
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node *
+rb_tree<T, Compare, Weight>::join_left(node *t, size_type height, node *mid,
+                                       node *left, size_type left_height) {
+  if ((t == nullptr || t->color == BLACK) && height == left_height)
+    return attach(mid, left, t, RED);
+
+  size_type child_height = t->color == BLACK ? height - 1 : height;
+  node *c = join_left(t->left, child_height, mid, left, left_height);
+  t->left = c;
+  c->parent = t;
+  if (t->color == BLACK && c->color == RED && c->left &&
+      c->left->color == RED) {
+    c->left->color = BLACK;
+    t->left = c->right;
+    if (c->right) c->right->parent = t;
+    c->right = t;
+    t->parent = c;
+    update_weight(t);
+    update_weight(c);
+    return c;
+  }
+  update_weight(t);
+  return t;
+}
+
+// Removes the largest node of t, returned in last, and gives back what
+// remains of t.
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::subtree
+rb_tree<T, Compare, Weight>::split_last(subtree t, node *&last) {
+  node *nd = t.root;
+  subtree left = detach_child(nd->left, t.height);
+  subtree right = detach_child(nd->right, t.height);
+  if (right.root == nullptr) {
+    last = nd;
+    return left;
+  }
+  return join(left, nd, split_last(right, last));
+}
+
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::node *rb_tree<T, Compare, Weight>::attach(
+    node *mid, node *left, node *right, node_colors color) {
+  mid->left = left;
+  mid->right = right;
+  mid->color = color;
+  if (left) left->parent = mid;
+  if (right) right->parent = mid;
+  update_weight(mid);
+  return mid;
+}
+
+// Detaches a whole tree, measuring its black height down the left spine.
+// This happens once per set operation; the pieces cut from the tree
+// afterwards get their heights from detach_child().
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::subtree
+rb_tree<T, Compare, Weight>::detach(node *t) {
+  if (t == nullptr) return {};
+  t->parent = nullptr;
+  t->color = BLACK;
+  size_type height = 0;
+  for (node *nd = t; nd; nd = nd->left)
+    if (nd->color == BLACK) height++;
+  return {t, height};
+}
+
+// Detaches child from the root of a subtree of the given height. The root
+// counts as black there, so the child is one lower unless it is red and
+// would be painted black on its own.
+template <typename T, typename Compare, typename Weight>
+typename rb_tree<T, Compare, Weight>::subtree
+rb_tree<T, Compare, Weight>::detach_child(node *child, size_type height) {
+  if (child == nullptr) return {};
+  child->parent = nullptr;
+  return {child, child->color == RED ? height : height - 1};
+}
+
+// How many levels of the recursion fork a second thread.
+template <typename T, typename Compare, typename Weight>
+int rb_tree<T, Compare, Weight>::fork_levels(unsigned threads, size_type n,
+                                             size_type m) {
+  if (std::min(n, m) < parallel_min_size) return 0;
+  int levels = 0;
+  while ((2u << levels) <= threads) levels++;
+  return levels;
+}
+
+// In-order walk of a detached subtree; f may destroy the node it is given.
+template <typename T, typename Compare, typename Weight>
+template <typename F>
+void rb_tree<T, Compare, Weight>::for_each_node(node *t, F &&f) {
+  if (t == nullptr) return;
+  for_each_node(t->left, f);
+  node *right = t->right;
+  f(t);
+  for_each_node(right, f);
 }
 
 }  // namespace my
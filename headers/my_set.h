@@ -6,32 +6,66 @@
 
 namespace my {
 
-template <typename T>
-class set : public rb_tree<T> {
+// OrderStatistics adds a subtree size to every node for nth(), rank()
+// and count_range().
+template <typename T, typename Compare = std::less<T>,
+          bool OrderStatistics = false>
+class set
+    : public rb_tree<T, Compare,
+                     std::conditional_t<OrderStatistics, unit_weight, void>> {
+  using tree_type =
+      rb_tree<T, Compare,
+              std::conditional_t<OrderStatistics, unit_weight, void>>;
+
  public:
   using key_type = T;
+  using key_compare = Compare;
   using reference = T &;
   using const_reference = const T &;
+  using iterator = typename tree_type::iterator;
   using size_type = size_t;
 
-  set() : rb_tree<key_type>() {}
+  set() : tree_type() {}
+  explicit set(const Compare &comp) : tree_type(comp) {}
   set(std::initializer_list<T> const &items);
 
+  template <typename InputIt>
+  static set from_sorted(InputIt first, InputIt last,
+                         const Compare &comp = Compare());
+
+  key_compare key_comp() const;
+
   template <typename... Args>
-  Vector<std::pair<typename rb_tree<T>::iterator, bool>> insert_many(
-      Args &&...args);
+  Vector<std::pair<iterator, bool>> insert_many(Args &&...args);
 };
 
-template <typename T>
-set<T>::set(std::initializer_list<T> const &items) {
-  for (auto it = items.begin(); it != items.end(); it++) this->insert(*it);
+template <typename T, typename Compare, bool OrderStatistics>
+set<T, Compare, OrderStatistics>::set(std::initializer_list<T> const &items) {
+  this->assign_sorted(items.begin(), items.end());
+}
+
+template <typename T, typename Compare, bool OrderStatistics>
+template <typename InputIt>
+set<T, Compare, OrderStatistics>
+set<T, Compare, OrderStatistics>::from_sorted(InputIt first, InputIt last,
+                                              const Compare &comp) {
+  set res(comp);
+  res.assign_sorted(first, last);
+  return res;
+}
+
+template <typename T, typename Compare, bool OrderStatistics>
+typename set<T, Compare, OrderStatistics>::key_compare
+set<T, Compare, OrderStatistics>::key_comp() const {
+  return this->comp_;
 }
 
-template <typename T>
+template <typename T, typename Compare, bool OrderStatistics>
 template <typename... Args>
-Vector<std::pair<typename rb_tree<T>::iterator, bool>> set<T>::insert_many(
-    Args &&...args) {
-  Vector<std::pair<typename rb_tree<T>::iterator, bool>> res;
+Vector<std::pair<typename set<T, Compare, OrderStatistics>::iterator, bool>>
+set<T, Compare, OrderStatistics>::insert_many(Args &&...args) {
+  Vector<std::pair<iterator, bool>> res;
+  res.reserve(sizeof...(Args));
 
   size_type count = sizeof...(Args);
   if (count == 0) throw std::runtime_error("Error: Zero args");
@@ -0,0 +1,535 @@
+#ifndef _MY_CONTAINER_SIMD_H
+#define _MY_CONTAINER_SIMD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MY_SIMD_X86 1
+#include <immintrin.h>
+#define MY_SIMD_AVX2 __attribute__((target("avx2"), always_inline)) inline
+#define MY_SIMD_SSE42 __attribute__((target("sse4.2"), always_inline)) inline
+#define MY_SIMD_AVX2_KERNEL __attribute__((target("avx2")))
+#define MY_SIMD_SSE42_KERNEL __attribute__((target("sse4.2")))
+#endif
+
+// Vectorized kernels over contiguous ranges (my::Vector, my::array and
+// anything else exposing data() and size()). The instruction set is picked
+// at run time: AVX2, then SSE4.2, then a scalar loop. Element types without
+// a vector kernel always take the scalar path.
+//
+// find/count/equal compare floating point values with operator==
+// semantics; sum of floating point values is reassociated, so it may
+// differ from a left-to-right sum in the last bits; min/max of ranges
+// containing NaN are unspecified.
+namespace my {
+namespace simd {
+
+enum class isa { scalar, sse42, avx2 };
+
+namespace detail {
+
+inline isa &isa_limit() {
+  static isa limit = isa::avx2;
+  return limit;
+}
+
+template <typename T>
+inline constexpr bool is_lane_type_v =
+    (std::is_integral_v<T> || std::is_floating_point_v<T>) &&
+    !std::is_same_v<T, bool> && !std::is_same_v<T, long double>;
+
+template <typename T>
+inline constexpr bool is_arith_lane_type_v =
+    std::is_same_v<T, std::int32_t> || std::is_same_v<T, float> ||
+    std::is_same_v<T, double>;
+
+template <typename T>
+const T *find_scalar(const T *first, const T *last, const T &value) {
+  for (; first != last; ++first)
+    if (*first == value) return first;
+  return last;
+}
+
+template <typename T>
+std::size_t count_scalar(const T *first, const T *last, const T &value) {
+  std::size_t res = 0;
+  for (; first != last; ++first) res += *first == value;
+  return res;
+}
+
+template <typename T>
+T sum_scalar(const T *first, const T *last, T init) {
+  if constexpr (std::is_integral_v<T>) {
+    // wrap around like the vector lanes do instead of overflowing
+    using U = std::make_unsigned_t<T>;
+    U res = static_cast<U>(init);
+    for (; first != last; ++first) res += static_cast<U>(*first);
+    return static_cast<T>(res);
+  } else {
+    for (; first != last; ++first) init += *first;
+    return init;
+  }
+}
+
+enum class reduce_op { min, max, sum };
+
+template <reduce_op Op, typename T>
+T reduce_scalar(const T *first, const T *last, T seed) {
+  if constexpr (Op == reduce_op::sum) {
+    return sum_scalar(first, last, seed);
+  } else {
+    for (; first != last; ++first) {
+      if constexpr (Op == reduce_op::min)
+        seed = *first < seed ? *first : seed;
+      else
+        seed = seed < *first ? *first : seed;
+    }
+    return seed;
+  }
+}
+
+// Object representation of value as a same-sized integer.
+template <typename T>
+auto bits_of(const T &value) {
+  using bits = std::conditional_t<
+      sizeof(T) == 2, std::int16_t,
+      std::conditional_t<sizeof(T) == 4, std::int32_t, long long>>;
+  bits res;
+  std::memcpy(&res, &value, sizeof(T));
+  return res;
+}
+
+#ifdef MY_SIMD_X86
+
+// Byte mask of the lanes of p[0..32/sizeof(T)) equal to value.
+template <typename T>
+MY_SIMD_AVX2 unsigned eq_mask_avx2(const T *p, const T &value) {
+  if constexpr (std::is_same_v<T, float>) {
+    __m256 eq =
+        _mm256_cmp_ps(_mm256_loadu_ps(p), _mm256_set1_ps(value), _CMP_EQ_OQ);
+    return _mm256_movemask_epi8(_mm256_castps_si256(eq));
+  } else if constexpr (std::is_same_v<T, double>) {
+    __m256d eq =
+        _mm256_cmp_pd(_mm256_loadu_pd(p), _mm256_set1_pd(value), _CMP_EQ_OQ);
+    return _mm256_movemask_epi8(_mm256_castpd_si256(eq));
+  } else {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i eq;
+    if constexpr (sizeof(T) == 1)
+      eq = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(value));
+    else if constexpr (sizeof(T) == 2)
+      eq = _mm256_cmpeq_epi16(v, _mm256_set1_epi16(value));
+    else if constexpr (sizeof(T) == 4)
+      eq = _mm256_cmpeq_epi32(v, _mm256_set1_epi32(value));
+    else
+      eq = _mm256_cmpeq_epi64(v, _mm256_set1_epi64x(value));
+    return _mm256_movemask_epi8(eq);
+  }
+}
+
+template <typename T>
+MY_SIMD_SSE42 unsigned eq_mask_sse42(const T *p, const T &value) {
+  if constexpr (std::is_same_v<T, float>) {
+    __m128 eq = _mm_cmpeq_ps(_mm_loadu_ps(p), _mm_set1_ps(value));
+    return _mm_movemask_epi8(_mm_castps_si128(eq));
+  } else if constexpr (std::is_same_v<T, double>) {
+    __m128d eq = _mm_cmpeq_pd(_mm_loadu_pd(p), _mm_set1_pd(value));
+    return _mm_movemask_epi8(_mm_castpd_si128(eq));
+  } else {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i eq;
+    if constexpr (sizeof(T) == 1)
+      eq = _mm_cmpeq_epi8(v, _mm_set1_epi8(value));
+    else if constexpr (sizeof(T) == 2)
+      eq = _mm_cmpeq_epi16(v, _mm_set1_epi16(value));
+    else if constexpr (sizeof(T) == 4)
+      eq = _mm_cmpeq_epi32(v, _mm_set1_epi32(value));
+    else
+      eq = _mm_cmpeq_epi64(v, _mm_set1_epi64x(value));
+    return _mm_movemask_epi8(eq);
+  }
+}
+
+template <typename T>
+MY_SIMD_AVX2_KERNEL const T *find_avx2(const T *first, const T *last,
+                                       const T &value) {
+  constexpr std::size_t lanes = 32 / sizeof(T);
+  for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+    unsigned mask = eq_mask_avx2(first, value);
+    if (mask) return first + __builtin_ctz(mask) / sizeof(T);
+  }
+  return find_scalar(first, last, value);
+}
+
+template <typename T>
+MY_SIMD_SSE42_KERNEL const T *find_sse42(const T *first, const T *last,
+                                         const T &value) {
+  constexpr std::size_t lanes = 16 / sizeof(T);
+  for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+    unsigned mask = eq_mask_sse42(first, value);
+    if (mask) return first + __builtin_ctz(mask) / sizeof(T);
+  }
+  return find_scalar(first, last, value);
+}
+
+template <typename T>
+MY_SIMD_AVX2_KERNEL std::size_t count_avx2(const T *first, const T *last,
+                                           const T &value) {
+  constexpr std::size_t lanes = 32 / sizeof(T);
+  std::size_t bits = 0;
+  for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes)
+    bits += __builtin_popcount(eq_mask_avx2(first, value));
+  return bits / sizeof(T) + count_scalar(first, last, value);
+}
+
+template <typename T>
+MY_SIMD_SSE42_KERNEL std::size_t count_sse42(const T *first, const T *last,
+                                             const T &value) {
+  constexpr std::size_t lanes = 16 / sizeof(T);
+  std::size_t bits = 0;
+  for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes)
+    bits += __builtin_popcount(eq_mask_sse42(first, value));
+  return bits / sizeof(T) + count_scalar(first, last, value);
+}
+
+// Reductions keep one accumulator register seeded with seed (an element
+// for min/max, zero for sum), fold its lanes and then the scalar tail.
+template <reduce_op Op, typename T>
+MY_SIMD_AVX2_KERNEL T reduce_avx2(const T *first, const T *last, T seed) {
+  constexpr std::size_t lanes = 32 / sizeof(T);
+  alignas(32) T acc[lanes];
+  std::fill(acc, acc + lanes, seed);
+  if constexpr (std::is_same_v<T, float>) {
+    __m256 a = _mm256_load_ps(acc);
+    for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+      __m256 v = _mm256_loadu_ps(first);
+      if constexpr (Op == reduce_op::min)
+        a = _mm256_min_ps(a, v);
+      else if constexpr (Op == reduce_op::max)
+        a = _mm256_max_ps(a, v);
+      else
+        a = _mm256_add_ps(a, v);
+    }
+    _mm256_store_ps(acc, a);
+  } else if constexpr (std::is_same_v<T, double>) {
+    __m256d a = _mm256_load_pd(acc);
+    for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+      __m256d v = _mm256_loadu_pd(first);
+      if constexpr (Op == reduce_op::min)
+        a = _mm256_min_pd(a, v);
+      else if constexpr (Op == reduce_op::max)
+        a = _mm256_max_pd(a, v);
+      else
+        a = _mm256_add_pd(a, v);
+    }
+    _mm256_store_pd(acc, a);
+  } else {
+    __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(acc));
+    for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+      if constexpr (Op == reduce_op::min)
+        a = _mm256_min_epi32(a, v);
+      else if constexpr (Op == reduce_op::max)
+        a = _mm256_max_epi32(a, v);
+      else
+        a = _mm256_add_epi32(a, v);
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i *>(acc), a);
+  }
+  seed = reduce_scalar<Op>(acc, acc + lanes, seed);
+  return reduce_scalar<Op>(first, last, seed);
+}
+
+template <reduce_op Op, typename T>
+MY_SIMD_SSE42_KERNEL T reduce_sse42(const T *first, const T *last, T seed) {
+  constexpr std::size_t lanes = 16 / sizeof(T);
+  alignas(16) T acc[lanes];
+  std::fill(acc, acc + lanes, seed);
+  if constexpr (std::is_same_v<T, float>) {
+    __m128 a = _mm_load_ps(acc);
+    for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+      __m128 v = _mm_loadu_ps(first);
+      if constexpr (Op == reduce_op::min)
+        a = _mm_min_ps(a, v);
+      else if constexpr (Op == reduce_op::max)
+        a = _mm_max_ps(a, v);
+      else
+        a = _mm_add_ps(a, v);
+    }
+    _mm_store_ps(acc, a);
+  } else if constexpr (std::is_same_v<T, double>) {
+    __m128d a = _mm_load_pd(acc);
+    for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+      __m128d v = _mm_loadu_pd(first);
+      if constexpr (Op == reduce_op::min)
+        a = _mm_min_pd(a, v);
+      else if constexpr (Op == reduce_op::max)
+        a = _mm_max_pd(a, v);
+      else
+        a = _mm_add_pd(a, v);
+    }
+    _mm_store_pd(acc, a);
+  } else {
+    __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(acc));
+    for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+      if constexpr (Op == reduce_op::min)
+        a = _mm_min_epi32(a, v);
+      else if constexpr (Op == reduce_op::max)
+        a = _mm_max_epi32(a, v);
+      else
+        a = _mm_add_epi32(a, v);
+    }
+    _mm_store_si128(reinterpret_cast<__m128i *>(acc), a);
+  }
+  seed = reduce_scalar<Op>(acc, acc + lanes, seed);
+  return reduce_scalar<Op>(first, last, seed);
+}
+
+template <typename T>
+MY_SIMD_AVX2_KERNEL void fill_avx2(T *first, T *last, const T &value) {
+  constexpr std::size_t lanes = 32 / sizeof(T);
+  __m256i v;
+  if constexpr (sizeof(T) == 2)
+    v = _mm256_set1_epi16(bits_of(value));
+  else if constexpr (sizeof(T) == 4)
+    v = _mm256_set1_epi32(bits_of(value));
+  else
+    v = _mm256_set1_epi64x(bits_of(value));
+  for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(first), v);
+  std::fill(first, last, value);
+}
+
+template <typename T>
+MY_SIMD_SSE42_KERNEL void fill_sse42(T *first, T *last, const T &value) {
+  constexpr std::size_t lanes = 16 / sizeof(T);
+  __m128i v;
+  if constexpr (sizeof(T) == 2)
+    v = _mm_set1_epi16(bits_of(value));
+  else if constexpr (sizeof(T) == 4)
+    v = _mm_set1_epi32(bits_of(value));
+  else
+    v = _mm_set1_epi64x(bits_of(value));
+  for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes)
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(first), v);
+  std::fill(first, last, value);
+}
+
+// Floating point equality is not bitwise (NaN, signed zero), so it is
+// compared lane by lane; everything else goes through memcmp.
+template <typename T>
+MY_SIMD_AVX2_KERNEL bool equal_avx2(const T *first, const T *last,
+                                    const T *other) {
+  constexpr std::size_t lanes = 32 / sizeof(T);
+  for (; static_cast<std::size_t>(last - first) >= lanes;
+       first += lanes, other += lanes) {
+    int mask;
+    if constexpr (std::is_same_v<T, float>)
+      mask = _mm256_movemask_ps(_mm256_cmp_ps(
+          _mm256_loadu_ps(first), _mm256_loadu_ps(other), _CMP_EQ_OQ));
+    else
+      mask = _mm256_movemask_pd(_mm256_cmp_pd(
+          _mm256_loadu_pd(first), _mm256_loadu_pd(other), _CMP_EQ_OQ));
+    if (mask != (1 << lanes) - 1) return false;
+  }
+  return std::equal(first, last, other);
+}
+
+template <typename T>
+MY_SIMD_SSE42_KERNEL bool equal_sse42(const T *first, const T *last,
+                                      const T *other) {
+  constexpr std::size_t lanes = 16 / sizeof(T);
+  for (; static_cast<std::size_t>(last - first) >= lanes;
+       first += lanes, other += lanes) {
+    int mask;
+    if constexpr (std::is_same_v<T, float>)
+      mask = _mm_movemask_ps(
+          _mm_cmpeq_ps(_mm_loadu_ps(first), _mm_loadu_ps(other)));
+    else
+      mask = _mm_movemask_pd(
+          _mm_cmpeq_pd(_mm_loadu_pd(first), _mm_loadu_pd(other)));
+    if (mask != (1 << lanes) - 1) return false;
+  }
+  return std::equal(first, last, other);
+}
+
+#endif  // MY_SIMD_X86
+
+}  // namespace detail
+
+inline isa detected_isa() {
+#ifdef MY_SIMD_X86
+  static const isa level = __builtin_cpu_supports("avx2")     ? isa::avx2
+                           : __builtin_cpu_supports("sse4.2") ? isa::sse42
+                                                              : isa::scalar;
+  return level;
+#else
+  return isa::scalar;
+#endif
+}
+
+inline isa active_isa() {
+  return std::min(detected_isa(), detail::isa_limit());
+}
+
+// Caps the instruction set used by the kernels, e.g. to benchmark or test
+// the narrower paths on a wider machine.
+inline void limit_isa(isa level) { detail::isa_limit() = level; }
+
+template <typename T>
+const T *find(const T *first, const T *last, const T &value) {
+#ifdef MY_SIMD_X86
+  if constexpr (detail::is_lane_type_v<T>) {
+    isa level = active_isa();
+    if (level == isa::avx2) return detail::find_avx2(first, last, value);
+    if (level == isa::sse42) return detail::find_sse42(first, last, value);
+  }
+#endif
+  return detail::find_scalar(first, last, value);
+}
+
+template <typename T>
+std::size_t count(const T *first, const T *last, const T &value) {
+#ifdef MY_SIMD_X86
+  if constexpr (detail::is_lane_type_v<T>) {
+    isa level = active_isa();
+    if (level == isa::avx2) return detail::count_avx2(first, last, value);
+    if (level == isa::sse42) return detail::count_sse42(first, last, value);
+  }
+#endif
+  return detail::count_scalar(first, last, value);
+}
+
+namespace detail {
+
+template <reduce_op Op, typename T>
+T reduce(const T *first, const T *last, T seed) {
+#ifdef MY_SIMD_X86
+  if constexpr (is_arith_lane_type_v<T>) {
+    isa level = active_isa();
+    if (level == isa::avx2) return reduce_avx2<Op>(first, last, seed);
+    if (level == isa::sse42) return reduce_sse42<Op>(first, last, seed);
+  }
+#endif
+  return reduce_scalar<Op>(first, last, seed);
+}
+
+}  // namespace detail
+
+template <typename T>
+T min(const T *first, const T *last) {
+  if (first == last) throw std::out_of_range("simd::min of an empty range");
+  return detail::reduce<detail::reduce_op::min>(first, last, *first);
+}
+
+template <typename T>
+T max(const T *first, const T *last) {
+  if (first == last) throw std::out_of_range("simd::max of an empty range");
+  return detail::reduce<detail::reduce_op::max>(first, last, *first);
+}
+
+template <typename T>
+T sum(const T *first, const T *last, T init = T()) {
+  T res = detail::reduce<detail::reduce_op::sum>(first, last, T());
+  return detail::sum_scalar(&res, &res + 1, init);
+}
+
+template <typename T>
+void fill(T *first, T *last, const T &value) {
+  if constexpr (sizeof(T) == 1 && std::is_trivially_copyable_v<T>) {
+    unsigned char byte;
+    std::memcpy(&byte, &value, 1);
+    if (first != last) std::memset(first, byte, last - first);
+    return;
+  }
+#ifdef MY_SIMD_X86
+  if constexpr (std::is_trivially_copyable_v<T> &&
+                (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) {
+    isa level = active_isa();
+    if (level == isa::avx2) return detail::fill_avx2(first, last, value);
+    if (level == isa::sse42) return detail::fill_sse42(first, last, value);
+  }
+#endif
+  std::fill(first, last, value);
+}
+
+// Only types whose operator== is built in and bitwise go to memcmp; a
+// class may define equality its own way even with a unique object
+// representation.
+template <typename T>
+bool equal(const T *first, const T *last, const T *other) {
+  if constexpr (std::is_integral_v<T> || std::is_enum_v<T> ||
+                std::is_pointer_v<T>) {
+    return first == last ||
+           std::memcmp(first, other, (last - first) * sizeof(T)) == 0;
+  }
+#ifdef MY_SIMD_X86
+  if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+    isa level = active_isa();
+    if (level == isa::avx2) return detail::equal_avx2(first, last, other);
+    if (level == isa::sse42) return detail::equal_sse42(first, last, other);
+  }
+#endif
+  return std::equal(first, last, other);
+}
+
+// memchr-style scan: address of the first byte equal to byte, or nullptr.
+inline const void *find_byte(const void *data, std::size_t n,
+                             unsigned char byte) {
+  const unsigned char *first = static_cast<const unsigned char *>(data);
+  const unsigned char *res = find(first, first + n, byte);
+  return res == first + n ? nullptr : res;
+}
+
+// Container overloads: c is anything with contiguous data() and size().
+
+template <typename Container>
+auto find(Container &c, const typename Container::value_type &value) {
+  return find(c.data(), c.data() + c.size(), value);
+}
+
+template <typename Container>
+std::size_t count(Container &c, const typename Container::value_type &value) {
+  return count(c.data(), c.data() + c.size(), value);
+}
+
+template <typename Container>
+auto min(Container &c) {
+  return min(c.data(), c.data() + c.size());
+}
+
+template <typename Container>
+auto max(Container &c) {
+  return max(c.data(), c.data() + c.size());
+}
+
+template <typename Container>
+auto sum(Container &c) {
+  return sum(c.data(), c.data() + c.size());
+}
+
+template <typename Container>
+void fill(Container &c, const typename Container::value_type &value) {
+  fill(c.data(), c.data() + c.size(), value);
+}
+
+template <typename Container1, typename Container2>
+bool equal(Container1 &a, Container2 &b) {
+  return a.size() == b.size() &&
+         equal(a.data(), a.data() + a.size(), b.data());
+}
+
+template <typename Container>
+const void *find_byte(Container &c, unsigned char byte) {
+  return find_byte(c.data(), c.size() * sizeof(*c.data()), byte);
+}
+
+}  // namespace simd
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_SIMD_H
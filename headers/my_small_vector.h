@@ -0,0 +1,504 @@
+#ifndef _MY_CONTAINER_SMALL_VECTOR_H
+#define _MY_CONTAINER_SMALL_VECTOR_H
+
+#include "my_vector.h"
+
+namespace my {
+
+// Vector that keeps up to N elements in an inline buffer and only moves to
+// the heap once it outgrows it. The interface mirrors my::Vector.
+template <typename T, std::size_t N>
+class small_vector {
+  static_assert(N > 0, "small_vector needs a non-empty inline buffer");
+
+ public:
+  using value_type = T;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = T *;
+  using const_iterator = const T *;
+  using size_type = size_t;
+
+  small_vector();
+  explicit small_vector(size_type n);
+  small_vector(std::initializer_list<value_type> const &items);
+  small_vector(const small_vector &v);
+  small_vector(small_vector &&v) noexcept(
+      std::is_nothrow_move_constructible_v<T>);
+
+  ~small_vector();
+
+  small_vector &operator=(small_vector &&v) noexcept(
+      std::is_nothrow_move_constructible_v<T>);
+
+  reference at(size_type pos);
+  reference operator[](size_type pos);
+  const_reference front();
+  const_reference back();
+  T *data();
+
+  iterator begin();
+  iterator end();
+
+  bool empty();
+  size_type size();
+  size_type max_size();
+  void reserve(size_type size);
+  size_type capacity();
+  void shrink_to_fit();
+  bool is_inline();
+
+  void clear();
+  iterator insert(iterator pos, const_reference value);
+  iterator insert(iterator pos, size_type count, const_reference value);
+
+  template <typename InputIt,
+            typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+  iterator insert(iterator pos, InputIt first, InputIt last);
+
+  template <typename... Args>
+  iterator insert_many(const_iterator pos, Args &&...args);
+
+  template <typename... Args>
+  void insert_many_back(Args &&...args);
+
+  void erase(iterator pos);
+  iterator erase(iterator first, iterator last);
+
+  template <typename UnaryPredicate>
+  size_type remove_if(UnaryPredicate pred);
+
+  void push_back(const_reference value);
+  void push_back(value_type &&value);
+
+  template <typename... Args>
+  reference emplace_back(Args &&...args);
+
+  void pop_back();
+  void swap(small_vector &other);
+
+ private:
+  static constexpr bool relocatable = is_trivially_relocatable_v<T>;
+
+  T *inline_data();
+  static T *allocate(size_type n);
+  void deallocate();
+  static void destroy(T *first, T *last);
+  static void relocate_range(T *first, T *last, T *dest);
+  void steal(small_vector &v);
+  void relocate(size_type new_cap);
+  void grow(size_type required);
+
+  size_type len;
+  size_type cap;
+  T *values;
+  alignas(T) unsigned char buffer[sizeof(T) * N];
+};
+
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector() : len(0), cap(N), values(inline_data()) {}
+
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(size_type n) : small_vector() {
+  reserve(n);
+  std::uninitialized_value_construct_n(values, n);
+  len = n;
+}
+
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(
+    const std::initializer_list<value_type> &items)
+    : small_vector() {
+  insert(end(), items.begin(), items.end());
+}
+
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(const small_vector &v) : small_vector() {
+  reserve(v.len);
+  std::uninitialized_copy(v.values, v.values + v.len, values);
+  len = v.len;
+}
+
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(small_vector &&v) noexcept(
+    std::is_nothrow_move_constructible_v<T>)
+    : small_vector() {
+  steal(v);
+}
+
+template <typename T, std::size_t N>
+small_vector<T, N>::~small_vector() {
+  destroy(values, values + len);
+  deallocate();
+}
+
+template <typename T, std::size_t N>
+small_vector<T, N> &small_vector<T, N>::operator=(small_vector &&v) noexcept(
+    std::is_nothrow_move_constructible_v<T>) {
+  if (this != &v) {
+    destroy(values, values + len);
+    deallocate();
+    len = 0;
+    cap = N;
+    values = inline_data();
+    steal(v);
+  }
+  return *this;
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::reference small_vector<T, N>::at(size_type pos) {
+  if (pos >= len) {
+    throw std::out_of_range("pos >= this->size()");
+  }
+  return values[pos];
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::reference small_vector<T, N>::operator[](
+    size_type pos) {
+  MY_CONTAINERS_ASSERT(pos < len, "small_vector index out of range");
+  return values[pos];
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference small_vector<T, N>::front() {
+  MY_CONTAINERS_ASSERT(len > 0, "front() on an empty small_vector");
+  return values[0];
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference small_vector<T, N>::back() {
+  MY_CONTAINERS_ASSERT(len > 0, "back() on an empty small_vector");
+  return values[len - 1];
+}
+
+template <typename T, std::size_t N>
+T *small_vector<T, N>::data() {
+  return values;
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::begin() {
+  return values;
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::end() {
+  return values + len;
+}
+
+template <typename T, std::size_t N>
+bool small_vector<T, N>::empty() {
+  return len == 0;
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::size_type small_vector<T, N>::size() {
+  return len;
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::size_type small_vector<T, N>::max_size() {
+  return std::numeric_limits<size_type>::max() / sizeof(value_type);
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::reserve(size_type size) {
+  if (size <= cap) return;
+  relocate(size);
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::size_type small_vector<T, N>::capacity() {
+  return cap;
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::shrink_to_fit() {
+  if (is_inline() || len == cap) return;
+  relocate(len);
+}
+
+template <typename T, std::size_t N>
+bool small_vector<T, N>::is_inline() {
+  return values == inline_data();
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::clear() {
+  destroy(values, values + len);
+  len = 0;
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::insert(
+    iterator pos, const_reference value) {
+  return insert(pos, 1, value);
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::insert(
+    iterator pos, size_type count, const_reference value) {
+  size_type index = pos - begin();
+  if (count == 0) return pos;
+  // value may refer to an element that is about to be shifted or relocated
+  value_type tmp(value);
+
+  if (len + count > cap) {
+    grow(len + count);
+  }
+
+  if constexpr (relocatable) {
+    relocate_range(values + index, values + len, values + index + count);
+    try {
+      std::uninitialized_fill_n(values + index, count, tmp);
+    } catch (...) {
+      relocate_range(values + index + count, values + len + count,
+                     values + index);
+      throw;
+    }
+    len += count;
+  } else {
+    size_type old_len = len;
+    std::uninitialized_fill_n(values + len, count, tmp);
+    len += count;
+    std::rotate(values + index, values + old_len, values + len);
+  }
+  return begin() + index;
+}
+
+template <typename T, std::size_t N>
+template <typename InputIt, typename>
+typename small_vector<T, N>::iterator small_vector<T, N>::insert(
+    iterator pos, InputIt first, InputIt last) {
+  using category = typename std::iterator_traits<InputIt>::iterator_category;
+  size_type index = pos - begin();
+  size_type old_len = len;
+
+  if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+    size_type count = std::distance(first, last);
+    if (count == 0) return pos;
+    if (len + count > cap) {
+      grow(len + count);
+    }
+
+    if constexpr (relocatable) {
+      relocate_range(values + index, values + len, values + index + count);
+      try {
+        std::uninitialized_copy(first, last, values + index);
+      } catch (...) {
+        relocate_range(values + index + count, values + len + count,
+                       values + index);
+        throw;
+      }
+      len += count;
+      return begin() + index;
+    }
+    std::uninitialized_copy(first, last, values + len);
+    len += count;
+  } else {
+    // single-pass input: collect at the end, then shift once
+    for (; first != last; ++first) emplace_back(*first);
+  }
+  std::rotate(values + index, values + old_len, values + len);
+  return begin() + index;
+}
+
+template <typename T, std::size_t N>
+template <typename... Args>
+typename small_vector<T, N>::iterator small_vector<T, N>::insert_many(
+    const_iterator pos, Args &&...args) {
+  size_type index = pos - begin();
+  size_type old_len = len;
+
+  try {
+    insert_many_back(std::forward<Args>(args)...);
+  } catch (...) {
+    // the elements already appended would otherwise stay at the back
+    while (len > old_len) pop_back();
+    throw;
+  }
+  std::rotate(values + index, values + old_len, values + len);
+  return begin() + index;
+}
+
+template <typename T, std::size_t N>
+template <typename... Args>
+void small_vector<T, N>::insert_many_back(Args &&...args) {
+  size_type new_len = len + sizeof...(Args);
+
+  if constexpr (sizeof...(Args) > 0) {
+    if (new_len > cap) {
+      // args may refer to elements of this vector
+      value_type tmp[] = {value_type(std::forward<Args>(args))...};
+      grow(new_len);
+      for (value_type &item : tmp) {
+        new (values + len) T(std::move(item));
+        ++len;
+      }
+      return;
+    }
+  }
+  ((new (values + len) T(std::forward<Args>(args)), ++len), ...);
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::erase(iterator pos) {
+  erase(pos, pos + 1);
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::erase(
+    iterator first, iterator last) {
+  size_type index = first - begin();
+  size_type count = last - first;
+
+  if constexpr (relocatable) {
+    destroy(first, last);
+    relocate_range(last, end(), first);
+  } else {
+    std::move(last, end(), first);
+    destroy(end() - count, end());
+  }
+  len -= count;
+  return begin() + index;
+}
+
+template <typename T, std::size_t N>
+template <typename UnaryPredicate>
+typename small_vector<T, N>::size_type small_vector<T, N>::remove_if(
+    UnaryPredicate pred) {
+  iterator first = std::remove_if(begin(), end(), pred);
+  size_type count = end() - first;
+
+  erase(first, end());
+  return count;
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::push_back(const_reference value) {
+  emplace_back(value);
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::push_back(value_type &&value) {
+  emplace_back(std::move(value));
+}
+
+template <typename T, std::size_t N>
+template <typename... Args>
+typename small_vector<T, N>::reference small_vector<T, N>::emplace_back(
+    Args &&...args) {
+  if (len == cap) {
+    // args may refer to an element of this vector
+    value_type tmp(std::forward<Args>(args)...);
+    grow(len + 1);
+    new (values + len) T(std::move(tmp));
+  } else {
+    new (values + len) T(std::forward<Args>(args)...);
+  }
+  return values[len++];
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::pop_back() {
+  if (len > 0) {
+    --len;
+    values[len].~T();
+  }
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::swap(small_vector &other) {
+  if (!is_inline() && !other.is_inline()) {
+    std::swap(values, other.values);
+    std::swap(len, other.len);
+    std::swap(cap, other.cap);
+  } else {
+    small_vector tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+}
+
+// private small_vector
+
+template <typename T, std::size_t N>
+T *small_vector<T, N>::inline_data() {
+  return reinterpret_cast<T *>(buffer);
+}
+
+template <typename T, std::size_t N>
+T *small_vector<T, N>::allocate(size_type n) {
+  if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+    throw std::bad_array_new_length();
+  return static_cast<T *>(
+      ::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::deallocate() {
+  if (!is_inline()) ::operator delete(values, std::align_val_t(alignof(T)));
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::destroy(T *first, T *last) {
+  for (; first != last; ++first) first->~T();
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::relocate_range(T *first, T *last, T *dest) {
+  if constexpr (relocatable) {
+    if (first != last)
+      std::memmove(static_cast<void *>(dest), static_cast<const void *>(first),
+                   (last - first) * sizeof(T));
+  } else {
+    std::uninitialized_move(first, last, dest);
+    destroy(first, last);
+  }
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::steal(small_vector &v) {
+  if (v.is_inline()) {
+    relocate_range(v.values, v.values + v.len, values);
+  } else {
+    values = v.values;
+    cap = v.cap;
+    v.values = v.inline_data();
+    v.cap = N;
+  }
+  len = v.len;
+  v.len = 0;
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::relocate(size_type new_cap) {
+  T *tmp = new_cap <= N ? inline_data() : allocate(new_cap);
+  if (tmp == values) return;
+  try {
+    relocate_range(values, values + len, tmp);
+  } catch (...) {
+    if (tmp != inline_data())
+      ::operator delete(tmp, std::align_val_t(alignof(T)));
+    throw;
+  }
+
+  deallocate();
+  values = tmp;
+  cap = new_cap <= N ? N : new_cap;
+}
+
+template <typename T, std::size_t N>
+void small_vector<T, N>::grow(size_type required) {
+  size_type new_cap = cap;
+  while (new_cap < required) {
+    new_cap *= 2;
+  }
+  reserve(new_cap);
+}
+
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_SMALL_VECTOR_H
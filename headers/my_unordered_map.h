@@ -0,0 +1,234 @@
+#ifndef _MY_CONTAINER_UNORDERED_MAP_H
+#define _MY_CONTAINER_UNORDERED_MAP_H
+
+#include <tuple>
+
+#include "my_hash_table.h"
+#include "my_vector.h"
+
+namespace my {
+
+// map without an order: point lookups in O(1) expected time, iteration in
+// no particular order.
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class unordered_map
+    : public hash_table<std::pair<Key, T>, pair_first_hash<Key, T, Hash>,
+                        pair_first_equal<Key, T, KeyEqual>> {
+  using table_type =
+      hash_table<std::pair<Key, T>, pair_first_hash<Key, T, Hash>,
+                 pair_first_equal<Key, T, KeyEqual>>;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<key_type, mapped_type>;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using iterator = typename table_type::iterator;
+  using size_type = size_t;
+
+  unordered_map() : table_type() {}
+  explicit unordered_map(const Hash &hash, const KeyEqual &eq = KeyEqual())
+      : table_type(pair_first_hash<Key, T, Hash>{hash},
+                   pair_first_equal<Key, T, KeyEqual>{eq}) {}
+  unordered_map(std::initializer_list<value_type> const &items);
+
+  Hash hash_function() const;
+  KeyEqual key_eq() const;
+
+  T &at(const Key &key);
+  // A missing key is inserted with a value-initialised T by the same
+  // lookup that finds where it goes.
+  T &operator[](const Key &key);
+  T &operator[](Key &&key);
+
+  std::pair<iterator, bool> insert(const value_type &value);
+  std::pair<iterator, bool> insert(const Key &key, const T &obj);
+
+  // One lookup each. try_emplace builds the value from args only when key
+  // is missing; insert_or_assign otherwise assigns obj to the value found.
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args);
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const Key &key, M &&obj);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(Key &&key, M &&obj);
+
+  bool contains(const Key &key);
+  iterator find(const Key &key);
+
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  iterator find(const K &key);
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  bool contains(const K &key);
+
+  template <typename... Args>
+  Vector<std::pair<iterator, bool>> insert_many(Args &&...args);
+
+ private:
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_key(K &&key, Args &&...args);
+  template <typename K, typename M>
+  std::pair<iterator, bool> assign_key(K &&key, M &&obj);
+};
+
+// A repeated key keeps the last value, as if the items were assigned one
+// after the other.
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+unordered_map<Key, T, Hash, KeyEqual>::unordered_map(
+    std::initializer_list<value_type> const &items) {
+  this->reserve(items.size());
+  for (const value_type &item : items)
+    insert_or_assign(item.first, item.second);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+Hash unordered_map<Key, T, Hash, KeyEqual>::hash_function() const {
+  return this->hash_.hash;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+KeyEqual unordered_map<Key, T, Hash, KeyEqual>::key_eq() const {
+  return this->eq_.eq;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+T &unordered_map<Key, T, Hash, KeyEqual>::at(const Key &key) {
+  size_type i = this->find_index(key, this->hash_of(key));
+  if (i == table_type::npos) throw std::runtime_error("Error: No such key");
+  return this->slots_[i].second;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+T &unordered_map<Key, T, Hash, KeyEqual>::operator[](const Key &key) {
+  return (*try_emplace_key(key).first).second;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+T &unordered_map<Key, T, Hash, KeyEqual>::operator[](Key &&key) {
+  return (*try_emplace_key(std::move(key)).first).second;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator, bool>
+unordered_map<Key, T, Hash, KeyEqual>::insert(const value_type &value) {
+  return insert(value.first, value.second);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator, bool>
+unordered_map<Key, T, Hash, KeyEqual>::insert(const Key &key, const T &obj) {
+  return try_emplace_key(key, obj);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator, bool>
+unordered_map<Key, T, Hash, KeyEqual>::try_emplace(const Key &key,
+                                                   Args &&...args) {
+  return try_emplace_key(key, std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator, bool>
+unordered_map<Key, T, Hash, KeyEqual>::try_emplace(Key &&key, Args &&...args) {
+  return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename M>
+std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator, bool>
+unordered_map<Key, T, Hash, KeyEqual>::insert_or_assign(const Key &key,
+                                                        M &&obj) {
+  return assign_key(key, std::forward<M>(obj));
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename M>
+std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator, bool>
+unordered_map<Key, T, Hash, KeyEqual>::insert_or_assign(Key &&key, M &&obj) {
+  return assign_key(std::move(key), std::forward<M>(obj));
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+bool unordered_map<Key, T, Hash, KeyEqual>::contains(const Key &key) {
+  return this->find_index(key, this->hash_of(key)) != table_type::npos;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename unordered_map<Key, T, Hash, KeyEqual>::iterator
+unordered_map<Key, T, Hash, KeyEqual>::find(const Key &key) {
+  size_type i = this->find_index(key, this->hash_of(key));
+  return i == table_type::npos ? this->end() : iterator(this, i);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename H, typename E, typename, typename>
+typename unordered_map<Key, T, Hash, KeyEqual>::iterator
+unordered_map<Key, T, Hash, KeyEqual>::find(const K &key) {
+  size_type i = this->find_index(key, this->hash_of(key));
+  return i == table_type::npos ? this->end() : iterator(this, i);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename H, typename E, typename, typename>
+bool unordered_map<Key, T, Hash, KeyEqual>::contains(const K &key) {
+  return this->find_index(key, this->hash_of(key)) != table_type::npos;
+}
+
+// The table is grown for all the arguments up front, so the returned
+// iterators stay valid.
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+Vector<std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator,
+                 bool>>
+unordered_map<Key, T, Hash, KeyEqual>::insert_many(Args &&...args) {
+  Vector<std::pair<iterator, bool>> res;
+
+  this->reserve(this->size() + sizeof...(Args));
+  for (const auto &arg : {args...}) res.push_back(insert(arg));
+
+  return res;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename... Args>
+std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator, bool>
+unordered_map<Key, T, Hash, KeyEqual>::try_emplace_key(K &&key,
+                                                       Args &&...args) {
+  typename unordered_map::insert_position pos = this->find_insert_pos(key);
+
+  if (pos.found)
+    return std::pair<iterator, bool>(iterator(this, pos.index), false);
+  return std::pair<iterator, bool>(
+      this->insert_at(pos, std::piecewise_construct,
+                      std::forward_as_tuple(std::forward<K>(key)),
+                      std::forward_as_tuple(std::forward<Args>(args)...)),
+      true);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename M>
+std::pair<typename unordered_map<Key, T, Hash, KeyEqual>::iterator, bool>
+unordered_map<Key, T, Hash, KeyEqual>::assign_key(K &&key, M &&obj) {
+  typename unordered_map::insert_position pos = this->find_insert_pos(key);
+
+  if (pos.found) {
+    this->slots_[pos.index].second = std::forward<M>(obj);
+    return std::pair<iterator, bool>(iterator(this, pos.index), false);
+  }
+  return std::pair<iterator, bool>(
+      this->insert_at(pos, std::forward<K>(key), std::forward<M>(obj)), true);
+}
+
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_UNORDERED_MAP_H
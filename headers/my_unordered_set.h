@@ -0,0 +1,73 @@
+#ifndef _MY_CONTAINER_UNORDERED_SET_H
+#define _MY_CONTAINER_UNORDERED_SET_H
+
+#include "my_hash_table.h"
+#include "my_vector.h"
+
+namespace my {
+
+// set without an order: point lookups in O(1) expected time, iteration in
+// no particular order.
+template <typename Key, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class unordered_set : public hash_table<Key, Hash, KeyEqual> {
+  using table_type = hash_table<Key, Hash, KeyEqual>;
+
+ public:
+  using key_type = Key;
+  using reference = Key &;
+  using const_reference = const Key &;
+  using iterator = typename table_type::iterator;
+  using size_type = size_t;
+
+  unordered_set() : table_type() {}
+  explicit unordered_set(const Hash &hash, const KeyEqual &eq = KeyEqual())
+      : table_type(hash, eq) {}
+  unordered_set(std::initializer_list<Key> const &items);
+
+  Hash hash_function() const;
+  KeyEqual key_eq() const;
+
+  template <typename... Args>
+  Vector<std::pair<iterator, bool>> insert_many(Args &&...args);
+};
+
+template <typename Key, typename Hash, typename KeyEqual>
+unordered_set<Key, Hash, KeyEqual>::unordered_set(
+    std::initializer_list<Key> const &items) {
+  this->reserve(items.size());
+  for (const Key &item : items) this->insert(item);
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+Hash unordered_set<Key, Hash, KeyEqual>::hash_function() const {
+  return this->hash_;
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+KeyEqual unordered_set<Key, Hash, KeyEqual>::key_eq() const {
+  return this->eq_;
+}
+
+// The table is grown for all the arguments up front, so the returned
+// iterators stay valid.
+template <typename Key, typename Hash, typename KeyEqual>
+template <typename... Args>
+Vector<std::pair<typename unordered_set<Key, Hash, KeyEqual>::iterator, bool>>
+unordered_set<Key, Hash, KeyEqual>::insert_many(Args &&...args) {
+  Vector<std::pair<iterator, bool>> res;
+
+  size_type count = sizeof...(Args);
+  if (count == 0) throw std::runtime_error("Error: Zero args");
+  Key tmp[sizeof...(Args)] = {std::forward<Args>(args)...};
+  this->reserve(this->size() + count);
+  for (size_type i = 0; i < count; i++) {
+    res.push_back(this->insert(tmp[i]));
+  }
+
+  return res;
+}
+
+}  // namespace my
+
+#endif  // !_MY_CONTAINER_UNORDERED_SET_H
@@ -1,14 +1,83 @@
 #ifndef CPP2_MY_CONTAINERS_SRC_MY_VECTOR_H_
 #define CPP2_MY_CONTAINERS_SRC_MY_VECTOR_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "my_checks.h"
 
 namespace my {
+
+// Types whose objects can be moved to another address with a plain memcpy,
+// the source then being treated as raw memory. Specialize it for user types
+// that qualify (e.g. types holding only owning pointers).
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T1, typename T2>
+struct is_trivially_relocatable<std::pair<T1, T2>>
+    : std::bool_constant<is_trivially_relocatable<T1>::value &&
+                         is_trivially_relocatable<T2>::value> {};
+
 template <typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+// Growth policies: next<T>(cap, required) returns the capacity to grow to,
+// which is never less than required.
+struct growth_2x {
+  template <typename T>
+  static constexpr std::size_t next(std::size_t cap, std::size_t required) {
+    return std::max(cap * 2, required);
+  }
+};
+
+struct growth_1_5x {
+  template <typename T>
+  static constexpr std::size_t next(std::size_t cap, std::size_t required) {
+    return std::max(cap + cap / 2, required);
+  }
+};
+
+template <std::size_t Step>
+struct growth_fixed_step {
+  static_assert(Step > 0, "growth step must be positive");
+
+  template <typename T>
+  static constexpr std::size_t next(std::size_t cap, std::size_t required) {
+    return cap + (required - cap + Step - 1) / Step * Step;
+  }
+};
+
+// Doubles, then rounds the buffer up to whole pages once it spans one, so
+// that huge buffers do not leave a partially used page at the end.
+template <std::size_t PageSize = 4096>
+struct growth_page_rounded {
+  template <typename T>
+  static constexpr std::size_t next(std::size_t cap, std::size_t required) {
+    std::size_t bytes = std::max(cap * 2, required) * sizeof(T);
+    if (bytes >= PageSize) bytes = (bytes + PageSize - 1) / PageSize * PageSize;
+    return bytes / sizeof(T);
+  }
+};
+
+template <typename T, typename Allocator = std::allocator<T>,
+          typename GrowthPolicy = growth_2x>
 class Vector {
  public:
   using value_type = T;
+  using allocator_type = Allocator;
+  using growth_policy = GrowthPolicy;
   using reference = T &;
   using const_reference = const T &;
   using iterator = T *;
@@ -16,14 +85,21 @@ class Vector {
   using size_type = size_t;
 
   Vector();
-  explicit Vector(size_type n);
-  Vector(std::initializer_list<value_type> const &items);
+  explicit Vector(const Allocator &alloc);
+  explicit Vector(size_type n, const Allocator &alloc = Allocator());
+  Vector(std::initializer_list<value_type> const &items,
+         const Allocator &alloc = Allocator());
   Vector(const Vector &v);
   Vector(Vector &&v) noexcept;
 
   ~Vector();
 
-  Vector &operator=(Vector &&v) noexcept;
+  Vector &operator=(Vector &&v) noexcept(
+      std::allocator_traits<
+          Allocator>::propagate_on_container_move_assignment::value ||
+      std::allocator_traits<Allocator>::is_always_equal::value);
+
+  allocator_type get_allocator() const;
 
   reference at(size_type pos);
   reference operator[](size_type pos);
@@ -43,6 +119,11 @@ class Vector {
 
   void clear();
   iterator insert(iterator pos, const_reference value);
+  iterator insert(iterator pos, size_type count, const_reference value);
+
+  template <typename InputIt,
+            typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+  iterator insert(iterator pos, InputIt first, InputIt last);
 
   template <typename... Args>
   iterator insert_many(const_iterator pos, Args &&...args);
@@ -51,297 +132,609 @@ class Vector {
   void insert_many_back(Args &&...args);
 
   void erase(iterator pos);
+  iterator erase(iterator first, iterator last);
+
+  template <typename UnaryPredicate>
+  size_type remove_if(UnaryPredicate pred);
+
   void push_back(const_reference value);
+  void push_back(value_type &&value);
+
+  template <typename... Args>
+  reference emplace_back(Args &&...args);
+
   void pop_back();
   void swap(Vector &other);
 
  private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  // Trivially relocatable elements are shifted with memmove. With the
+  // default allocator and malloc's alignment sufficing, the buffer comes
+  // from malloc and is grown in place with realloc.
+  static constexpr bool relocatable = is_trivially_relocatable_v<T>;
+  static constexpr bool reallocatable =
+      relocatable && alignof(T) <= alignof(std::max_align_t) &&
+      std::is_same_v<Allocator, std::allocator<T>>;
+
+  // Storage is raw memory: only [0, len) holds constructed elements.
+  // Allocation failures are reported with std::bad_alloc.
+  T *allocate(size_type n);
+  static T *reallocate(T *ptr, size_type n);
+  void deallocate(T *ptr, size_type n);
+
+  template <typename... Args>
+  void construct(T *ptr, Args &&...args);
+  template <typename InputIt>
+  void construct_range(InputIt first, InputIt last, T *dest);
+  void construct_fill(T *dest, size_type n, const_reference value);
+  void destroy(T *first, T *last);
+
+  static void relocate_range(T *first, T *last, T *dest);
+  void relocate(size_type new_cap);
+  void grow(size_type required);
+  void steal(Vector &v);
+
   size_type len;
   size_type cap;
   T *values;
+  Allocator alloc;
 };
 
-template <typename T>
-Vector<T>::Vector() : len(0), cap(15) {
-  values = new T[cap];
-}
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy>::Vector() : Vector(Allocator()) {}
 
-template <typename T>
-Vector<T>::Vector(Vector::size_type n) {
-  cap = 15;
-  if (n >= cap) {
-    while (n >= cap) {
-      cap *= 2;
-    }
-  }
-  len = n;
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy>::Vector(const Allocator &alloc)
+    : len(0), cap(0), values(nullptr), alloc(alloc) {}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy>::Vector(Vector::size_type n,
+                                           const Allocator &alloc)
+    : len(0), cap(n), values(nullptr), alloc(alloc) {
+  values = allocate(cap);
   try {
-    values = new T[cap];
-  } catch (std::bad_alloc &e) {
-    std::cerr << "Error: Unable to allocate memory -" << e.what() << std::endl;
-    exit(1);
-  }
-  for (size_type i = 0; i < len; i++) {
-    values[i] = 0;
+    for (; len < n; ++len) construct(values + len);
+  } catch (...) {
+    destroy(values, values + len);
+    deallocate(values, cap);
+    throw;
   }
 }
 
-template <typename T>
-Vector<T>::Vector(const std::initializer_list<value_type> &items) : Vector() {
-  for (const auto &item : items) {
-    push_back(item);
-  }
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy>::Vector(
+    const std::initializer_list<value_type> &items, const Allocator &alloc)
+    : Vector(alloc) {
+  insert(end(), items.begin(), items.end());
 }
 
-template <typename T>
-Vector<T>::Vector(const Vector &v) {
-  len = v.len;
-  cap = v.cap;
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy>::Vector(const Vector &v)
+    : len(0),
+      cap(v.len),
+      values(nullptr),
+      alloc(alloc_traits::select_on_container_copy_construction(v.alloc)) {
+  values = allocate(cap);
   try {
-    values = new T[cap];
-  } catch (std::bad_alloc &e) {
-    std::cerr << "Error: Unable to allocate memory -" << e.what() << std::endl;
-    exit(1);
-  }
-  for (size_type i = 0; i < len; i++) {
-    values[i] = v.values[i];
+    construct_range(v.values, v.values + v.len, values);
+  } catch (...) {
+    deallocate(values, cap);
+    throw;
   }
-}
-
-template <typename T>
-Vector<T>::Vector(Vector &&v) noexcept {
   len = v.len;
-  cap = v.cap;
-  values = v.values;
+}
 
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy>::Vector(Vector &&v) noexcept
+    : len(v.len), cap(v.cap), values(v.values), alloc(std::move(v.alloc)) {
   v.values = nullptr;
   v.len = 0;
   v.cap = 0;
 }
 
-template <typename T>
-Vector<T>::~Vector() {
-  delete[] values;
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy>::~Vector() {
+  destroy(values, values + len);
+  deallocate(values, cap);
 }
 
-template <typename T>
-Vector<T> &Vector<T>::operator=(Vector &&v) noexcept {
-  if (this != &v) {
-    delete[] values;
-    len = v.len;
-    cap = v.cap;
-    values = v.values;
-
-    v.len = 0;
-    v.cap = 0;
-    v.values = nullptr;
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy> &
+Vector<T, Allocator, GrowthPolicy>::operator=(Vector &&v) noexcept(
+    std::allocator_traits<
+        Allocator>::propagate_on_container_move_assignment::value ||
+    std::allocator_traits<Allocator>::is_always_equal::value) {
+  if (this == &v) return *this;
+
+  if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+    destroy(values, values + len);
+    deallocate(values, cap);
+    alloc = std::move(v.alloc);
+    steal(v);
+  } else {
+    if (alloc == v.alloc) {
+      destroy(values, values + len);
+      deallocate(values, cap);
+      steal(v);
+    } else {
+      // memory owned by a different resource cannot be adopted
+      clear();
+      reserve(v.len);
+      construct_range(std::make_move_iterator(v.values),
+                      std::make_move_iterator(v.values + v.len), values);
+      len = v.len;
+      v.clear();
+    }
   }
   return *this;
 }
 
-template <typename T>
-typename Vector<T>::reference Vector<T>::at(Vector::size_type pos) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::allocator_type
+Vector<T, Allocator, GrowthPolicy>::get_allocator() const {
+  return alloc;
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::reference
+Vector<T, Allocator, GrowthPolicy>::at(
+    Vector::size_type pos) {
   if (pos >= len) {
     throw std::out_of_range("pos >= this->size()");
   }
   return values[pos];
 }
 
-template <typename T>
-typename Vector<T>::reference Vector<T>::operator[](Vector::size_type pos) {
-  return at(pos);
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::reference
+Vector<T, Allocator, GrowthPolicy>::operator[](
+    Vector::size_type pos) {
+  MY_CONTAINERS_ASSERT(pos < len, "Vector index out of range");
+  return values[pos];
 }
 
-template <typename T>
-typename Vector<T>::const_reference Vector<T>::front() {
-  return at(0);
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::const_reference
+Vector<T, Allocator, GrowthPolicy>::front() {
+  MY_CONTAINERS_ASSERT(len > 0, "front() on an empty Vector");
+  return values[0];
 }
 
-template <typename T>
-typename Vector<T>::const_reference Vector<T>::back() {
-  return at(len - 1);
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::const_reference
+Vector<T, Allocator, GrowthPolicy>::back() {
+  MY_CONTAINERS_ASSERT(len > 0, "back() on an empty Vector");
+  return values[len - 1];
 }
 
-template <typename T>
-T *Vector<T>::data() {
+template <typename T, typename Allocator, typename GrowthPolicy>
+T *Vector<T, Allocator, GrowthPolicy>::data() {
   return values;
 }
 
-template <typename T>
-typename Vector<T>::iterator Vector<T>::begin() {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::iterator
+Vector<T, Allocator, GrowthPolicy>::begin() {
   return values;
 }
 
-template <typename T>
-typename Vector<T>::iterator Vector<T>::end() {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::iterator
+Vector<T, Allocator, GrowthPolicy>::end() {
   return values + len;
 }
 
-template <typename T>
-bool Vector<T>::empty() {
+template <typename T, typename Allocator, typename GrowthPolicy>
+bool Vector<T, Allocator, GrowthPolicy>::empty() {
   return len == 0;
 }
 
-template <typename T>
-typename Vector<T>::size_type Vector<T>::size() {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::size_type
+Vector<T, Allocator, GrowthPolicy>::size() {
   return len;
 }
 
-template <typename T>
-typename Vector<T>::size_type Vector<T>::max_size() {
-  return std::numeric_limits<size_type>::max();
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::size_type
+Vector<T, Allocator, GrowthPolicy>::max_size() {
+  return std::min<size_type>(
+      alloc_traits::max_size(alloc),
+      std::numeric_limits<size_type>::max() / sizeof(value_type));
 }
 
-template <typename T>
-void Vector<T>::reserve(Vector::size_type size) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::reserve(Vector::size_type size) {
   if (size <= cap) return;
-  T *tmp;
-  try {
-    tmp = new T[size];
-  } catch (std::bad_alloc &e) {
-    std::cerr << "Error: Unable to allocate memory -" << e.what() << std::endl;
-    exit(1);
-  }
-  for (size_type i = 0; i < len; i++) {
-    tmp[i] = values[i];
-  }
-
-  delete[] values;
-  values = tmp;
-  cap = size;
+  if (size > max_size()) throw std::length_error("size > this->max_size()");
+  relocate(size);
 }
 
-template <typename T>
-typename Vector<T>::size_type Vector<T>::capacity() {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::size_type
+Vector<T, Allocator, GrowthPolicy>::capacity() {
   return cap;
 }
 
-template <typename T>
-void Vector<T>::shrink_to_fit() {
-  if (cap * 0.75 <= len) return;
-  T *tmp;
-  try {
-    tmp = new T[len];
-  } catch (std::bad_alloc &e) {
-    std::cerr << "Error: Unable to allocate memory -" << e.what() << std::endl;
-    exit(1);
-  }
-  for (size_type i = 0; i < len; i++) {
-    tmp[i] = values[i];
-  }
-
-  delete[] values;
-  values = tmp;
-  cap = len;
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::shrink_to_fit() {
+  if (len == cap) return;
+  relocate(len);
 }
 
-template <typename T>
-void Vector<T>::clear() {
-  delete[] values;
-  values = new T[cap];
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::clear() {
+  destroy(values, values + len);
   len = 0;
 }
 
-template <typename T>
-typename Vector<T>::iterator Vector<T>::insert(Vector::iterator pos,
-                                               const_reference value) {
-  if (len + 1 >= cap) {
-    reserve(cap * 2);
-  }
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::iterator
+Vector<T, Allocator, GrowthPolicy>::insert(
+    Vector::iterator pos, const_reference value) {
   size_type index = pos - begin();
 
-  for (size_type i = len; i > index; --i) {
-    values[i] = values[i - 1];
+  if constexpr (relocatable) {
+    alignas(T) unsigned char buf[sizeof(T)];
+    T *tmp = new (buf) T(value);
+    try {
+      if (len == cap) grow(len + 1);
+    } catch (...) {
+      tmp->~T();
+      throw;
+    }
+    relocate_range(values + index, values + len, values + index + 1);
+    relocate_range(tmp, tmp + 1, values + index);
+    ++len;
+    return begin() + index;
   }
 
-  values[index] = value;
+  // value may refer to an element that is about to be shifted or relocated
+  value_type tmp(value);
+
+  if (len == cap) {
+    grow(len + 1);
+  }
+
+  if (index == len) {
+    construct(values + len, std::move(tmp));
+  } else {
+    construct(values + len, std::move(values[len - 1]));
+    std::move_backward(values + index, values + len - 1, values + len);
+    values[index] = std::move(tmp);
+  }
   ++len;
-  return pos;
+  return begin() + index;
 }
 
-template <typename T>
-template <typename... Args>
-typename Vector<T>::iterator Vector<T>::insert_many(Vector::const_iterator pos,
-                                                    Args &&...args) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::iterator
+Vector<T, Allocator, GrowthPolicy>::insert(
+    Vector::iterator pos, size_type count, const_reference value) {
   size_type index = pos - begin();
-  size_type count = sizeof...(Args);
+  if (count == 0) return pos;
+  // value may refer to an element that is about to be shifted or relocated
+  value_type tmp(value);
+
+  if (len + count > cap) {
+    grow(len + count);
+  }
 
-  size_type new_len = len + count;
-  size_type new_cap = cap;
-  if (new_len >= cap) {
-    while (new_len >= new_cap) {
-      new_cap *= 2;
+  if constexpr (relocatable) {
+    relocate_range(values + index, values + len, values + index + count);
+    try {
+      construct_fill(values + index, count, tmp);
+    } catch (...) {
+      relocate_range(values + index + count, values + len + count,
+                     values + index);
+      throw;
     }
-    reserve(new_len * 2);
+    len += count;
+  } else {
+    size_type old_len = len;
+    construct_fill(values + len, count, tmp);
+    len += count;
+    std::rotate(values + index, values + old_len, values + len);
   }
-  T tmp[sizeof...(Args)] = {std::forward<Args>(args)...};
+  return begin() + index;
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+template <typename InputIt, typename>
+typename Vector<T, Allocator, GrowthPolicy>::iterator
+Vector<T, Allocator, GrowthPolicy>::insert(
+    Vector::iterator pos, InputIt first, InputIt last) {
+  using category = typename std::iterator_traits<InputIt>::iterator_category;
+  size_type index = pos - begin();
+  size_type old_len = len;
+
+  if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+    size_type count = std::distance(first, last);
+    if (count == 0) return pos;
+    if (len + count > cap) {
+      grow(len + count);
+    }
 
-  for (size_type i = len + count - 1; i >= len; --i) {
-    values[i] = values[i - count];
+    if constexpr (relocatable) {
+      relocate_range(values + index, values + len, values + index + count);
+      try {
+        construct_range(first, last, values + index);
+      } catch (...) {
+        relocate_range(values + index + count, values + len + count,
+                       values + index);
+        throw;
+      }
+      len += count;
+      return begin() + index;
+    }
+    construct_range(first, last, values + len);
+    len += count;
+  } else {
+    // single-pass input: collect at the end, then shift once
+    for (; first != last; ++first) emplace_back(*first);
   }
+  std::rotate(values + index, values + old_len, values + len);
+  return begin() + index;
+}
 
-  for (size_type i = 0; i < count; ++i) {
-    values[index + i] = tmp[i];
+template <typename T, typename Allocator, typename GrowthPolicy>
+template <typename... Args>
+typename Vector<T, Allocator, GrowthPolicy>::iterator
+Vector<T, Allocator, GrowthPolicy>::insert_many(
+    Vector::const_iterator pos, Args &&...args) {
+  size_type index = pos - begin();
+  size_type old_len = len;
+
+  insert_many_back(std::forward<Args>(args)...);
+  if constexpr (relocatable && sizeof...(Args) > 0) {
+    alignas(T) unsigned char buf[sizeof(T) * sizeof...(Args)];
+    T *tmp = reinterpret_cast<T *>(buf);
+    relocate_range(values + old_len, values + len, tmp);
+    relocate_range(values + index, values + old_len,
+                   values + index + sizeof...(Args));
+    relocate_range(tmp, tmp + sizeof...(Args), values + index);
+  } else {
+    std::rotate(values + index, values + old_len, values + len);
   }
-  len += count;
   return begin() + index;
 }
 
-template <typename T>
+template <typename T, typename Allocator, typename GrowthPolicy>
 template <typename... Args>
-void Vector<T>::insert_many_back(Args &&...args) {
-  size_type count = sizeof...(Args);
-  size_type index = len;
-  size_type new_len = len + count;
-  size_type new_cap = cap;
-
-  if (new_len >= cap) {
-    while (new_len >= new_cap) {
-      new_cap *= 2;
+void Vector<T, Allocator, GrowthPolicy>::insert_many_back(Args &&...args) {
+  size_type new_len = len + sizeof...(Args);
+
+  if constexpr (sizeof...(Args) > 0) {
+    if (new_len > cap) {
+      // args may refer to elements of this vector
+      value_type tmp[] = {value_type(std::forward<Args>(args))...};
+      grow(new_len);
+      for (value_type &item : tmp) {
+        construct(values + len, std::move(item));
+        ++len;
+      }
+      return;
     }
-    reserve(new_cap);
   }
-  T tmp[sizeof...(Args)] = {std::forward<Args>(args)...};
+  ((construct(values + len, std::forward<Args>(args)), ++len), ...);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::erase(Vector::iterator pos) {
+  erase(pos, pos + 1);
+}
 
-  for (size_type i = 0; i < count; i++) {
-    values[i + index] = tmp[i];
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::iterator
+Vector<T, Allocator, GrowthPolicy>::erase(
+    Vector::iterator first, Vector::iterator last) {
+  size_type index = first - begin();
+  size_type count = last - first;
+
+  if constexpr (relocatable) {
+    destroy(first, last);
+    relocate_range(last, end(), first);
+  } else {
+    std::move(last, end(), first);
+    destroy(end() - count, end());
   }
+  len -= count;
+  return begin() + index;
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+template <typename UnaryPredicate>
+typename Vector<T, Allocator, GrowthPolicy>::size_type
+Vector<T, Allocator, GrowthPolicy>::remove_if(
+    UnaryPredicate pred) {
+  iterator first = std::remove_if(begin(), end(), pred);
+  size_type count = end() - first;
 
-  len += count;
+  erase(first, end());
+  return count;
 }
 
-template <typename T>
-void Vector<T>::erase(Vector::iterator pos) {
-  size_type index = pos - begin();
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::push_back(const_reference value) {
+  emplace_back(value);
+}
 
-  for (size_type i = index; i < len - 1; i++) {
-    values[i] = values[i + 1];
-  }
-  --len;
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::push_back(value_type &&value) {
+  emplace_back(std::move(value));
 }
 
-template <typename T>
-void Vector<T>::push_back(const_reference value) {
-  if (cap * 0.75 <= len) reserve(cap * 2);
-  values[len] = value;
-  ++len;
+template <typename T, typename Allocator, typename GrowthPolicy>
+template <typename... Args>
+typename Vector<T, Allocator, GrowthPolicy>::reference
+Vector<T, Allocator, GrowthPolicy>::emplace_back(
+    Args &&...args) {
+  if (len == cap) {
+    // args may refer to an element of this vector
+    value_type tmp(std::forward<Args>(args)...);
+    grow(len + 1);
+    construct(values + len, std::move(tmp));
+  } else {
+    construct(values + len, std::forward<Args>(args)...);
+  }
+  return values[len++];
 }
 
-template <typename T>
-void Vector<T>::pop_back() {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::pop_back() {
   if (len > 0) {
     --len;
+    destroy(values + len, values + len + 1);
   }
 }
 
-template <typename T>
-void Vector<T>::swap(Vector &other) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::swap(Vector &other) {
   T *tmp = other.values;
   other.values = values;
   values = tmp;
 
   std::swap(len, other.len);
   std::swap(cap, other.cap);
+  if constexpr (alloc_traits::propagate_on_container_swap::value) {
+    using std::swap;
+    swap(alloc, other.alloc);
+  }
+}
+
+// private Vector
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+T *Vector<T, Allocator, GrowthPolicy>::allocate(size_type n) {
+  if (n == 0) return nullptr;
+  if constexpr (reallocatable)
+    return reallocate(nullptr, n);
+  else
+    return alloc_traits::allocate(alloc, n);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+T *Vector<T, Allocator, GrowthPolicy>::reallocate(T *ptr, size_type n) {
+  if (n == 0) {
+    std::free(ptr);
+    return nullptr;
+  }
+  if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+    throw std::bad_array_new_length();
+  void *res = std::realloc(static_cast<void *>(ptr), n * sizeof(T));
+  if (res == nullptr) throw std::bad_alloc();
+  return static_cast<T *>(res);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::deallocate(T *ptr, size_type n) {
+  if constexpr (reallocatable)
+    std::free(ptr);
+  else if (ptr)
+    alloc_traits::deallocate(alloc, ptr, n);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+template <typename... Args>
+void Vector<T, Allocator, GrowthPolicy>::construct(T *ptr, Args &&...args) {
+  alloc_traits::construct(alloc, ptr, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+template <typename InputIt>
+void Vector<T, Allocator, GrowthPolicy>::construct_range(InputIt first,
+                                                         InputIt last,
+                                                         T *dest) {
+  T *cur = dest;
+  try {
+    for (; first != last; ++first, ++cur) construct(cur, *first);
+  } catch (...) {
+    destroy(dest, cur);
+    throw;
+  }
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::construct_fill(T *dest, size_type n,
+                                          const_reference value) {
+  T *cur = dest;
+  try {
+    for (; n > 0; --n, ++cur) construct(cur, value);
+  } catch (...) {
+    destroy(dest, cur);
+    throw;
+  }
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::destroy(T *first, T *last) {
+  if constexpr (!std::is_trivially_destructible_v<T>)
+    for (; first != last; ++first) alloc_traits::destroy(alloc, first);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::relocate_range(T *first, T *last,
+                                                        T *dest) {
+  if (first != last)
+    std::memmove(static_cast<void *>(dest), static_cast<const void *>(first),
+                 (last - first) * sizeof(T));
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::relocate(size_type new_cap) {
+  if constexpr (reallocatable) {
+    values = reallocate(values, new_cap);
+  } else if constexpr (relocatable) {
+    T *tmp = allocate(new_cap);
+    relocate_range(values, values + len, tmp);
+    deallocate(values, cap);
+    values = tmp;
+  } else {
+    T *tmp = allocate(new_cap);
+    try {
+      if constexpr (std::is_nothrow_move_constructible_v<T> ||
+                    !std::is_copy_constructible_v<T>)
+        construct_range(std::make_move_iterator(values),
+                        std::make_move_iterator(values + len), tmp);
+      else
+        construct_range(values, values + len, tmp);
+    } catch (...) {
+      deallocate(tmp, new_cap);
+      throw;
+    }
+
+    destroy(values, values + len);
+    deallocate(values, cap);
+    values = tmp;
+  }
+  cap = new_cap;
+}
+
+// The policy may overshoot max_size(); only required itself has to fit.
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::grow(size_type required) {
+  if (required > max_size()) throw std::length_error("size > this->max_size()");
+  size_type proposed = GrowthPolicy::template next<T>(cap, required);
+  reserve(std::max(std::min(proposed, max_size()), required));
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Vector<T, Allocator, GrowthPolicy>::steal(Vector &v) {
+  len = v.len;
+  cap = v.cap;
+  values = v.values;
+
+  v.len = 0;
+  v.cap = 0;
+  v.values = nullptr;
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy,
+          typename UnaryPredicate>
+typename Vector<T, Allocator, GrowthPolicy>::size_type erase_if(
+    Vector<T, Allocator, GrowthPolicy> &v, UnaryPredicate pred) {
+  return v.remove_if(pred);
 }
 }  // namespace my
 
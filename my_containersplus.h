@@ -2,6 +2,16 @@
 #define _MY_CONTAINERSPLUS_H
 
 #include "headers/my_array.h"
+#include "headers/my_btree_map.h"
+#include "headers/my_btree_multiset.h"
+#include "headers/my_btree_set.h"
+#include "headers/my_flat_map.h"
+#include "headers/my_flat_set.h"
+#include "headers/my_mapped_vector.h"
 #include "headers/my_multiset.h"
+#include "headers/my_simd.h"
+#include "headers/my_small_vector.h"
+#include "headers/my_unordered_map.h"
+#include "headers/my_unordered_set.h"
 
 #endif
\ No newline at end of file
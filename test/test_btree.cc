@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../headers/my_btree_map.h"
+#include "../headers/my_btree_multiset.h"
+#include "../headers/my_btree_set.h"
+
+TEST(BtreeSet, Test_1) {
+  my::btree_set<int> s;
+  EXPECT_EQ(true, s.insert(12).second);
+  EXPECT_EQ(true, s.insert(14).second);
+  EXPECT_EQ(false, s.insert(12).second);
+  EXPECT_EQ(true, s.insert(1).second);
+
+  EXPECT_EQ(true, s.find(14) != s.end());
+  EXPECT_EQ(false, s.find(4) != s.end());
+
+  s.erase(s.find(14));
+  EXPECT_EQ(false, s.contains(14));
+  EXPECT_EQ(2, s.size());
+  EXPECT_EQ(1, *s.begin());
+  EXPECT_EQ(12, *s.rbegin());
+}
+
+// Small nodes give a tree several levels deep, so splits, borrowing and
+// merges of inner nodes all happen.
+TEST(BtreeSet, Test_2) {
+  my::btree_set<int, std::less<int>, 16> s;
+
+  for (int i = 0; i < 20000; i++) s.insert(i * 7919 % 20000);
+  EXPECT_EQ(20000, s.size());
+
+  int expected = 0;
+  for (auto it = s.begin(); it != s.end(); ++it) EXPECT_EQ(expected++, *it);
+  EXPECT_EQ(20000, expected);
+
+  for (int i = 0; i < 20000; i += 2) s.erase(s.find(i));
+  EXPECT_EQ(10000, s.size());
+  EXPECT_EQ(1, *s.begin());
+  EXPECT_EQ(19999, *--s.end());
+
+  for (int i = 1; i < 20000; i += 2) {
+    auto it = s.find(i);
+    EXPECT_EQ(true, it != s.end());
+    s.erase(it);
+  }
+  EXPECT_EQ(true, s.empty());
+  EXPECT_EQ(true, s.begin() == s.end());
+}
+
+TEST(BtreeSet, Test_3) {
+  my::btree_set<int> a = {5, 3, 9, 1, 3};
+  my::btree_set<int> b = {4, 5, 6};
+  EXPECT_EQ(4, a.size());
+
+  a.merge(b);
+  EXPECT_EQ(6, a.size());
+  EXPECT_EQ(1, b.size());
+  EXPECT_EQ(5, *b.begin());
+
+  my::btree_set<int> c(a);
+  c.insert(c.end(), 10);
+  c.insert(c.find(4), 2);
+  EXPECT_EQ(8, c.size());
+  EXPECT_EQ(6, a.size());
+
+  int expected[] = {1, 2, 3, 4, 5, 6, 9, 10};
+  int i = 0;
+  for (int v : c) EXPECT_EQ(expected[i++], v);
+}
+
+TEST(BtreeSet, Test_4) {
+  my::btree_set<int, std::less<int>, 64> s;
+  for (int i = 0; i < 3000; i++) s.insert((i * 7919) % 3000 * 2);
+
+  for (int key = -1; key < 6001; key++) {
+    int lower = key < 0 ? 0 : (key + 1) / 2 * 2;
+    int upper = key < 0 ? 0 : key / 2 * 2 + 2;
+    if (lower < 6000) {
+      EXPECT_EQ(lower, *s.lower_bound(key));
+    } else {
+      EXPECT_EQ(true, s.lower_bound(key) == s.end());
+    }
+    if (upper < 6000) {
+      EXPECT_EQ(upper, *s.upper_bound(key));
+    } else {
+      EXPECT_EQ(true, s.upper_bound(key) == s.end());
+    }
+    auto range = s.equal_range(key);
+    EXPECT_EQ(true, range.first == s.lower_bound(key));
+    EXPECT_EQ(true, range.second == s.upper_bound(key));
+  }
+}
+
+TEST(BtreeMap, Test_1) {
+  my::btree_map<std::string, int> m = {{"b", 2}, {"a", 1}, {"b", 3}};
+  EXPECT_EQ(2, m.size());
+  EXPECT_EQ(3, m.at("b"));
+  EXPECT_THROW(m.at("c"), std::runtime_error);
+
+  EXPECT_EQ(true, m.insert("c", 4).second);
+  EXPECT_EQ(false, m.insert("c", 5).second);
+  EXPECT_EQ(false, m.insert_or_assign("c", 6).second);
+  EXPECT_EQ(6, m["c"]);
+  EXPECT_EQ("a", m.begin()->first);
+
+  m.erase(m.find("a"));
+  EXPECT_EQ(false, m.contains("a"));
+  EXPECT_EQ("b", m.begin()->first);
+}
+
+TEST(BtreeMap, Test_2) {
+  my::btree_map<int, std::string, std::less<>, 64> m;
+  for (int i = 0; i < 3000; i++) m.insert(m.end(), {i, std::to_string(i)});
+  EXPECT_EQ(3000, m.size());
+
+  for (int i = 0; i < 3000; i += 3) m.erase(m.find(i));
+  EXPECT_EQ(2000, m.size());
+  EXPECT_EQ("1", m.at(1));
+  EXPECT_EQ(false, m.contains(2997));
+  EXPECT_EQ(true, m.find(2998L) != m.end());
+  EXPECT_EQ("2999", (*m.rbegin()).second);
+}
+
+TEST(BtreeMap, Test_3) {
+  my::btree_map<int, int, std::less<int>, 64> m;
+  for (int i = 0; i < 2000; i++) m[i % 500] += i;
+  EXPECT_EQ(500, m.size());
+  EXPECT_EQ(499 + 999 + 1499 + 1999, m[499]);
+
+  EXPECT_EQ(false, m.try_emplace(7, -1).second);
+  EXPECT_EQ(true, m.try_emplace(-7, -1).second);
+  EXPECT_EQ(true, m.insert_or_assign(-8, 8).second);
+  EXPECT_EQ(false, m.insert_or_assign(-8, 9).second);
+  EXPECT_EQ(9, m.at(-8));
+  EXPECT_EQ(false, m.emplace(-7, 0).second);
+  EXPECT_EQ(-8, (*m.begin()).first);
+}
+
+TEST(BtreeMultiset, Test_1) {
+  my::btree_multiset<int> ms = {5, 1, 5, 3, 5};
+  EXPECT_EQ(5, ms.size());
+  EXPECT_EQ(3, ms.count(5));
+
+  ms.insert(1);
+  EXPECT_EQ(2, ms.count(1));
+  ms.erase(ms.find(5));
+  EXPECT_EQ(2, ms.count(5));
+  EXPECT_EQ(5, ms.size());
+
+  my::btree_multiset<int> other = {5, 7};
+  ms.merge(other);
+  EXPECT_EQ(6, ms.size());
+  EXPECT_EQ(1, other.size());
+  EXPECT_EQ(true, ms.contains(7));
+}
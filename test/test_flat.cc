@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../headers/my_flat_map.h"
+#include "../headers/my_flat_set.h"
+
+TEST(FlatSet, Test_1) {
+  my::flat_set<int> s = {9, 4, 7, 4, 1};
+  EXPECT_EQ(4, s.size());
+  EXPECT_EQ(1, *s.begin());
+  EXPECT_EQ(9, *s.rbegin());
+
+  EXPECT_EQ(true, s.insert(5).second);
+  EXPECT_EQ(false, s.insert(7).second);
+  EXPECT_EQ(true, s.contains(5));
+  EXPECT_EQ(false, s.contains(6));
+
+  s.erase(s.find(4));
+  int expected[] = {1, 5, 7, 9};
+  int i = 0;
+  for (int v : s) EXPECT_EQ(expected[i++], v);
+  EXPECT_EQ(4, i);
+}
+
+TEST(FlatSet, Test_2) {
+  my::flat_set<int> s;
+  s.reserve(1000);
+  for (int i = 999; i >= 0; i--) s.insert(s.begin(), i * 3);
+  EXPECT_EQ(1000, s.size());
+  EXPECT_EQ(0, *s.begin());
+
+  for (int i = 0; i < 3000; i++) {
+    EXPECT_EQ(i % 3 == 0, s.contains(i));
+  }
+  EXPECT_EQ(true, s.find(3000) == s.end());
+  EXPECT_EQ(true, s.find(-1) == s.end());
+
+  my::flat_set<int> other = {1, 3, 5};
+  s.merge(other);
+  EXPECT_EQ(1002, s.size());
+  EXPECT_EQ(1, other.size());
+  EXPECT_EQ(3, *other.begin());
+}
+
+TEST(FlatMap, Test_1) {
+  my::flat_map<std::string, int> m = {{"b", 2}, {"a", 1}, {"b", 3}};
+  EXPECT_EQ(2, m.size());
+  EXPECT_EQ(3, m.at("b"));
+  EXPECT_THROW(m.at("c"), std::runtime_error);
+
+  EXPECT_EQ(true, m.insert("c", 4).second);
+  EXPECT_EQ(false, m.insert({"c", 5}).second);
+  EXPECT_EQ(false, m.insert_or_assign("c", 6).second);
+  EXPECT_EQ(6, m["c"]);
+  EXPECT_EQ("a", m.begin()->first);
+
+  (*m.find("a")).second = 10;
+  EXPECT_EQ(10, m.at("a"));
+  m.erase(m.find("a"));
+  EXPECT_EQ(false, m.contains("a"));
+  EXPECT_EQ("c", (*m.rbegin()).first);
+}
+
+TEST(FlatMap, Test_2) {
+  std::pair<int, std::string> items[] = {{3, "c"}, {1, "a"}, {2, "b"}};
+  auto m = my::flat_map<int, std::string, std::less<>>::from_sorted(
+      items, items + 3);
+  EXPECT_EQ(3, m.size());
+  EXPECT_EQ("a", m.begin()->second);
+  EXPECT_EQ(true, m.contains(2L));
+
+  my::flat_map<int, std::string, std::less<>> other = {{2, "x"}, {4, "d"}};
+  m.merge(other);
+  EXPECT_EQ(4, m.size());
+  EXPECT_EQ("b", m.at(2));
+  EXPECT_EQ("d", m.at(4));
+  EXPECT_EQ(1, other.size());
+  EXPECT_EQ("x", other.at(2));
+}
+
+TEST(FlatMap, Test_3) {
+  my::flat_map<std::string, int, std::less<>> mp = {
+      {"b", 2}, {"d", 4}, {"f", 6}};
+
+  EXPECT_EQ(4, mp.lower_bound("c")->second);
+  EXPECT_EQ(6, mp.upper_bound("d")->second);
+  EXPECT_EQ(true, mp.upper_bound("f") == mp.end());
+
+  auto range = mp.equal_range("d");
+  EXPECT_EQ(4, range.first->second);
+  EXPECT_EQ(6, range.second->second);
+  range = mp.equal_range("a");
+  EXPECT_EQ(true, range.first == range.second);
+  EXPECT_EQ(true, range.first == mp.begin());
+}
+
+TEST(FlatMap, Test_4) {
+  my::flat_map<std::string, int> m;
+  for (const char *word : {"y", "x", "y", "z"}) m[word]++;
+  EXPECT_EQ(3, m.size());
+  EXPECT_EQ(2, m["y"]);
+
+  EXPECT_EQ(false, m.try_emplace("x", 5).second);
+  EXPECT_EQ(1, m.at("x"));
+  EXPECT_EQ(true, m.emplace("w", 4).second);
+  EXPECT_EQ("w", m.begin()->first);
+  std::string key = "v";
+  EXPECT_EQ(true, m.insert_or_assign(std::move(key), 6).second);
+  EXPECT_EQ(6, m.begin()->second);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <thread>
+
 #include "../headers/my_map.h"
 
 TEST(map, Test_1) {
@@ -176,4 +179,279 @@ TEST(map, Test_11) {
   EXPECT_EQ(mp.size(), 4);
   EXPECT_EQ(res[0].second, true);
   EXPECT_EQ(res[1].second, false);
-}
\ No newline at end of file
+}
+TEST(map, Test_12) {
+  my::map<int, int> mp;
+  for (int i = 0; i < 100; i++) mp.insert(i, i * i);
+
+  auto it = mp.rbegin();
+  for (int i = 99; i >= 90; i--, ++it) EXPECT_EQ((*it).second, i * i);
+
+  for (int i = 50; i < 100; i++) mp.erase(mp.find(i));
+  EXPECT_EQ((*--mp.end()).first, 49);
+  for (int i = 0; i < 50; i++) mp.erase(mp.begin());
+  EXPECT_EQ(mp.begin(), mp.end());
+  EXPECT_EQ(mp.size(), 0);
+}
+
+TEST(map, Test_13) {
+  my::map<std::string, int, std::less<>> mp{{"one", 1}, {"two", 2}};
+  std::string_view key = "two";
+  EXPECT_EQ((*mp.find(key)).second, 2);
+  EXPECT_TRUE(mp.contains(std::string_view("one")));
+  EXPECT_FALSE(mp.contains(std::string_view("three")));
+
+  my::map<int, char, std::greater<int>> desc;
+  for (int i = 0; i < 10; i++) desc.insert(i, 'a' + i);
+  EXPECT_EQ((*desc.begin()).first, 9);
+  EXPECT_EQ(desc.at(3), 'd');
+  EXPECT_FALSE(desc.insert_or_assign(3, 'z').second);
+  EXPECT_EQ(desc.at(3), 'z');
+}
+
+TEST(map, Test_14) {
+  my::Vector<std::pair<int, std::string>> rows;
+  for (int i = 0; i < 100; i++) rows.push_back({i, std::to_string(i)});
+  auto mp = my::map<int, std::string>::from_sorted(rows.begin(), rows.end());
+  EXPECT_EQ(mp.size(), 100);
+  EXPECT_EQ(mp.at(42), "42");
+  EXPECT_EQ((*mp.rbegin()).first, 99);
+
+  my::map<int, char> dup{{2, 'a'}, {1, 'b'}, {2, 'c'}};
+  EXPECT_EQ(dup.size(), 2);
+  EXPECT_EQ(dup.at(2), 'c');
+}
+
+TEST(map, Test_15) {
+  my::map<int, char> mp{{1, 'a'}, {2, 'b'}, {3, 'c'}};
+  my::map<int, char> other{{2, 'x'}, {3, 'y'}, {4, 'z'}};
+
+  my::map<int, char> common = my::set_intersection(mp, other);
+  EXPECT_EQ(common.size(), 2);
+  EXPECT_EQ(common.at(2), 'b');
+
+  my::map<int, char> diff = my::set_difference(mp, other);
+  EXPECT_EQ(diff.size(), 1);
+  EXPECT_EQ(diff.at(1), 'a');
+
+  char *left_over = &other.at(3);
+  mp.merge(other);
+  EXPECT_EQ(mp.size(), 4);
+  EXPECT_EQ(mp.at(2), 'b');
+  EXPECT_EQ(mp.at(4), 'z');
+  EXPECT_EQ(other.size(), 2);
+  EXPECT_EQ(&other.at(3), left_over);
+  EXPECT_EQ(other.at(3), 'y');
+}
+
+TEST(map, Test_16) {
+  my::map<int, int> series;
+  auto hint = series.end();
+  for (int t = 0; t < 500; t++) hint = series.insert(hint, {t, t * t});
+  EXPECT_EQ(series.size(), 500);
+  EXPECT_EQ(series.at(499), 499 * 499);
+
+  auto it = series.insert(series.find(10), {10, -1});
+  EXPECT_EQ((*it).second, 100);
+  it = series.emplace_hint(series.end(), 1000, 7);
+  EXPECT_EQ((*it).first, 1000);
+  EXPECT_EQ(series.size(), 501);
+}
+
+TEST(map, Test_17) {
+  my::map<int, std::string> shard1{{1, "one"}, {2, "two"}, {3, "three"}};
+  my::map<int, std::string> shard2;
+
+  auto nh = shard1.extract(2);
+  EXPECT_EQ(nh.key(), 2);
+  EXPECT_EQ(nh.mapped(), "two");
+  nh.key() = 20;
+  auto res = shard2.insert(std::move(nh));
+  EXPECT_TRUE(res.inserted);
+  EXPECT_EQ(shard2.at(20), "two");
+  EXPECT_FALSE(shard1.contains(2));
+
+  nh = shard1.extract(shard1.begin());
+  EXPECT_EQ(nh.mapped(), "one");
+  nh.key() = 0;
+  shard1.insert(std::move(nh));
+  EXPECT_EQ((*shard1.begin()).first, 0);
+  EXPECT_EQ(shard1.size(), 2);
+}
+
+TEST(map, Test_18) {
+  my::map<int, std::string> mp;
+  for (int i = 0; i < 50; i++) mp.insert(i, std::string(100, 'a' + i % 26));
+  auto kept = mp.find(25);
+  std::string *value = &(*kept).second;
+
+  mp.erase(mp.find(24));
+  mp.erase(mp.find(26));
+  mp.erase(mp.find(0));
+  mp.erase(mp.find(49));
+  EXPECT_EQ(mp.size(), 46);
+  EXPECT_EQ(&(*mp.find(25)).second, value);
+  EXPECT_EQ((*mp.begin()).first, 1);
+  EXPECT_EQ((*mp.rbegin()).first, 48);
+  EXPECT_EQ((*++kept).first, 27);
+}
+
+TEST(map, Test_19) {
+  my::map<std::string, int, std::less<>> mp{{"b", 2}, {"d", 4}, {"f", 6}};
+
+  EXPECT_EQ((*mp.lower_bound("d")).second, 4);
+  EXPECT_EQ((*mp.upper_bound("d")).second, 6);
+  EXPECT_EQ((*mp.lower_bound(std::string_view("c"))).first, "d");
+  EXPECT_EQ(mp.upper_bound(std::string("f")), mp.end());
+
+  auto range = mp.equal_range(std::string("b"));
+  EXPECT_EQ((*range.first).second, 2);
+  EXPECT_EQ((*range.second).second, 4);
+  range = mp.equal_range("e");
+  EXPECT_EQ(range.first, range.second);
+  EXPECT_EQ((*range.first).first, "f");
+}
+
+TEST(map, Test_20) {
+  my::map<std::string, int> counts;
+  for (const char *word : {"b", "a", "b", "c", "b", "a"}) counts[word]++;
+  EXPECT_EQ(counts.size(), 3);
+  EXPECT_EQ(counts["a"], 2);
+  EXPECT_EQ(counts["b"], 3);
+  EXPECT_EQ(counts["d"], 0);
+  EXPECT_EQ(counts.size(), 4);
+
+  auto res = counts.try_emplace("a", 10);
+  EXPECT_FALSE(res.second);
+  EXPECT_EQ((*res.first).second, 2);
+  res = counts.emplace("e", 5);
+  EXPECT_TRUE(res.second);
+  EXPECT_FALSE(counts.emplace("e", 6).second);
+  EXPECT_EQ(counts.at("e"), 5);
+
+  my::map<int, std::unique_ptr<int>> owners;
+  EXPECT_TRUE(owners.try_emplace(1, std::make_unique<int>(1)).second);
+  EXPECT_FALSE(owners.try_emplace(1, std::make_unique<int>(2)).second);
+  EXPECT_EQ(*owners.at(1), 1);
+  EXPECT_FALSE(owners.insert_or_assign(1, std::make_unique<int>(3)).second);
+  EXPECT_EQ(*owners.at(1), 3);
+  owners[2] = std::make_unique<int>(4);
+  EXPECT_EQ(*owners.at(2), 4);
+}
+
+TEST(map, Test_21) {
+  my::map<std::string, int, std::less<>> mp{{"a", 1}, {"c", 3}, {"e", 5}};
+  std::string_view keys[] = {"e", "b", "a", "c", "f"};
+  my::map<std::string, int, std::less<>>::iterator found[5];
+
+  mp.find_many(std::begin(keys), std::end(keys), found, true);
+  EXPECT_EQ((*found[0]).second, 5);
+  EXPECT_EQ(found[1], mp.end());
+  EXPECT_EQ((*found[2]).second, 1);
+  EXPECT_EQ((*found[3]).second, 3);
+  EXPECT_EQ(found[4], mp.end());
+}
+
+TEST(map, Test_22) {
+  my::map<int, char> mp{{2, 'b'}};
+  std::vector<std::pair<int, char>> batch;
+  for (int i = 100; i > 0; i--) batch.push_back({i, char('a' + i % 26)});
+  batch.push_back({50, 'z'});
+
+  std::vector<std::pair<my::map<int, char>::iterator, bool>> res;
+  mp.insert(batch.begin(), batch.end(), std::back_inserter(res));
+  EXPECT_EQ(mp.size(), 100);
+  EXPECT_EQ(mp.at(2), 'b');
+  EXPECT_EQ(mp.at(50), 'a' + 50 % 26);
+  EXPECT_FALSE(res[98].second);
+  EXPECT_FALSE(res[100].second);
+  EXPECT_EQ((*res[100].first).first, 50);
+  EXPECT_EQ((*res[0].first).first, 100);
+
+  mp.insert(batch.begin(), batch.begin() + 3);
+  EXPECT_EQ(mp.size(), 100);
+}
+
+TEST(map, Test_23) {
+  my::map<int, std::string> target{{5, "five"}};
+  auto source = std::make_unique<my::map<int, std::string>>();
+  for (int i = 0; i < 40; i++) source->insert(i, std::string(30, 'a' + i % 26));
+
+  auto nh = source->extract(1);
+  auto nh2 = source->extract(2);
+  std::string *value = &nh.mapped();
+  source->clear();
+  source->insert(7, "seven");
+  EXPECT_TRUE(target.insert(std::move(nh)).inserted);
+  EXPECT_EQ(&target.at(1), value);
+
+  source.reset();
+  target.insert(std::move(nh2));
+  for (int i = 10; i < 30; i++) target.insert(i, "x");
+  target.erase(target.find(1));
+  EXPECT_EQ(target.size(), 22);
+  EXPECT_EQ(target.at(2), std::string(30, 'c'));
+}
+
+TEST(map, Test_24) {
+  my::map<int, std::string> shard1, shard2;
+  for (int i = 0; i < 1000; i++) {
+    shard1.insert(i, std::to_string(i));
+    shard2.insert(-i - 1, std::to_string(i));
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    shard2.insert(shard1.extract(i));
+    shard1.insert(shard2.extract(-i - 1));
+  }
+
+  // Each thread allocates from its own pool while it hands the nodes it
+  // got from the other shard back to the other pool.
+  auto churn = [](my::map<int, std::string> &mp, int base, int traded) {
+    for (int round = 0; round < 20; round++) {
+      for (int i = 0; i < 1000; i++) mp.insert(base + i, "x");
+      for (int i = 0; i < 1000; i++) mp.erase(mp.find(base + i));
+      for (int i = round; i < 1000; i += 20)
+        if (i % 2 == 0) mp.erase(mp.find(traded < 0 ? -i - 1 : i));
+    }
+  };
+  std::thread worker(churn, std::ref(shard1), 10000, -1);
+  churn(shard2, 20000, 1);
+  worker.join();
+
+  EXPECT_EQ(shard1.size(), 500);
+  EXPECT_EQ(shard2.size(), 500);
+  EXPECT_EQ(shard1.at(1), "1");
+  EXPECT_EQ(shard2.at(-2), "1");
+  EXPECT_FALSE(shard2.contains(2));
+}
+
+struct CountedValue {
+  static int built;
+  static int copied;
+  int v;
+  CountedValue(int x) : v(x) { built++; }
+  CountedValue(const CountedValue &o) : v(o.v) { copied++; }
+  CountedValue(CountedValue &&o) noexcept : v(o.v) {}
+};
+int CountedValue::built = 0;
+int CountedValue::copied = 0;
+
+TEST(map, Test_25) {
+  my::map<std::string, CountedValue> mp;
+  EXPECT_TRUE(mp.emplace("a", 1).second);
+  EXPECT_EQ(CountedValue::built, 1);
+
+  CountedValue::built = 0;
+  EXPECT_FALSE(mp.emplace("a", 2).second);
+  EXPECT_FALSE(mp.emplace(std::string("a"), 3).second);
+  EXPECT_EQ(CountedValue::built, 0);
+  EXPECT_EQ(mp.at("a").v, 1);
+
+  std::pair<std::string, CountedValue> item("b", 4);
+  CountedValue::copied = 0;
+  EXPECT_TRUE(mp.insert(std::move(item)).second);
+  EXPECT_FALSE(mp.emplace(std::pair<std::string, CountedValue>("b", 5)).second);
+  EXPECT_EQ(CountedValue::copied, 0);
+  EXPECT_EQ(mp.at("b").v, 4);
+  EXPECT_EQ(mp.size(), 2);
+}
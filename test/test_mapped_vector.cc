@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include "../headers/my_mapped_vector.h"
+
+using namespace my;
+
+TEST(MappedVectorTest, Growth) {
+  mapped_vector<long> v;
+  EXPECT_EQ(v.capacity(), 0);
+  EXPECT_EQ(v.data(), nullptr);
+
+  for (long i = 0; i < 100000; i++) v.push_back(i);
+  EXPECT_EQ(v.size(), 100000);
+  EXPECT_GE(v.capacity(), 100000);
+  for (long i = 0; i < 100000; i += 997) EXPECT_EQ(v[i], i);
+
+  v.insert(v.begin(), -1);
+  v.erase(v.begin() + 1);
+  EXPECT_EQ(v.front(), -1);
+  EXPECT_EQ(v.back(), 99999);
+}
+
+TEST(MappedVectorTest, Shrink_And_Advise) {
+  mapped_vector<int> v{1, 2, 3};
+  v.advise(mapped_vector<int>::advice::sequential);
+  v.reserve(1 << 20);
+  EXPECT_GE(v.capacity(), 1 << 20);
+  v.advise(mapped_vector<int>::advice::huge_pages);
+  v.insert_many_back(4, 5);
+  v.shrink_to_fit();
+  EXPECT_LT(v.capacity(), 1 << 20);
+  EXPECT_EQ(v.size(), 5);
+  EXPECT_EQ(v.at(4), 5);
+  EXPECT_THROW(v.at(5), std::out_of_range);
+
+  mapped_vector<int> w(std::move(v));
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(w.size(), 5);
+  v.swap(w);
+  EXPECT_EQ(v.size(), 5);
+  v.pop_back();
+  v.clear();
+  EXPECT_TRUE(v.empty());
+}
+
+TEST(MappedVectorTest, File_Backed) {
+  char path[] = "/tmp/my_mapped_vector_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+
+  {
+    mapped_vector<double> v(path);
+    EXPECT_TRUE(v.file_backed());
+    EXPECT_TRUE(v.empty());
+    for (int i = 0; i < 5000; i++) v.push_back(i * 0.5);
+    size_t capacity = v.capacity();
+    v.sync();
+    struct stat st;
+    ASSERT_EQ(stat(path, &st), 0);
+    EXPECT_EQ(st.st_size, 5000 * sizeof(double));
+    EXPECT_EQ(v.capacity(), capacity);
+
+    v.push_back(-1);
+    EXPECT_EQ(v.capacity(), capacity);
+    ASSERT_EQ(stat(path, &st), 0);
+    EXPECT_EQ(st.st_size, capacity * sizeof(double));
+    v.pop_back();
+  }
+  {
+    mapped_vector<double> v(path);
+    EXPECT_EQ(v.size(), 5000);
+    EXPECT_EQ(v[4999], 4999 * 0.5);
+    v.erase(v.begin());
+  }
+  {
+    mapped_vector<double> v(path);
+    EXPECT_EQ(v.size(), 4999);
+    EXPECT_EQ(v.front(), 0.5);
+  }
+  std::remove(path);
+}
@@ -69,7 +69,7 @@ TEST(Multiset, Test_5) {
 TEST(Multiset, Test_6) {
   my::multiset<int> ms{1, 2, 3, 3, 4, 4, 4, 5, 5};
 
-  auto it1 = ms.find(1);
+  auto it1 = ms.find(3);
 
   auto it2 = ms.upper_bound(2);
 
@@ -125,7 +125,8 @@ TEST(Multiset, Test_10) {
   auto pair_it = s.equal_range(2);
 
   EXPECT_EQ((*(pair_it.first)).first, 2);
-  EXPECT_EQ((*(pair_it.second)).first, 2);
+  EXPECT_EQ((*(pair_it.first)).second, 3);
+  EXPECT_EQ((*(pair_it.second)).first, 3);
 }
 
 TEST(Multiset, Test_11) {
@@ -144,3 +145,94 @@ TEST(Multiset, Test_12) {
 
   EXPECT_EQ(ms1.size(), 6);
 }
+
+TEST(Multiset, Test_13) {
+  my::multiset<int, std::greater<int>> ms{1, 3, 3, 2, 3};
+  EXPECT_EQ(ms.size(), 5);
+  EXPECT_EQ((*ms.begin()).first, 3);
+  EXPECT_EQ(ms.count(3), 3);
+  EXPECT_EQ(ms.count(4), 0);
+  EXPECT_EQ(ms.find(4), ms.end());
+}
+
+TEST(Multiset, Test_14) {
+  int keys[] = {1, 1, 2, 3, 3, 3};
+  auto ms = my::multiset<int>::from_sorted(keys, keys + 6);
+  EXPECT_EQ(ms.size(), 6);
+  EXPECT_EQ(ms.count(3), 3);
+  EXPECT_EQ(ms.count(2), 1);
+
+  int shuffled[] = {3, 1, 3, 2};
+  ms.assign_sorted(shuffled, shuffled + 4);
+  EXPECT_EQ(ms.size(), 4);
+  EXPECT_EQ(ms.count(3), 2);
+  EXPECT_EQ((*ms.begin()).first, 1);
+}
+
+TEST(Multiset, Test_15) {
+  my::multiset<int, std::less<int>, true> ms{5, 1, 3, 3, 3, 7, 7};
+  EXPECT_EQ((*ms.nth(0)).first, 1);
+  EXPECT_EQ((*ms.nth(1)).first, 3);
+  EXPECT_EQ((*ms.nth(3)).first, 3);
+  EXPECT_EQ((*ms.nth(4)).first, 5);
+  EXPECT_EQ((*ms.nth(6)).first, 7);
+  EXPECT_EQ(ms.nth(7), ms.end());
+  EXPECT_EQ(ms.rank(5), 4);
+  EXPECT_EQ(ms.count_range(3, 7), 4);
+
+  ms.insert(3);
+  EXPECT_EQ(ms.rank(5), 5);
+  ms.erase(ms.find(3));
+  ms.erase(ms.find(3));
+  EXPECT_EQ(ms.size(), 6);
+  EXPECT_EQ(ms.rank(5), 3);
+  EXPECT_EQ((*ms.nth(3)).first, 5);
+}
+
+TEST(Multiset, Test_16) {
+  my::multiset<int> ms;
+  for (int i = 0; i < 100; i++) ms.insert(ms.end(), i / 2);
+  EXPECT_EQ(ms.size(), 100);
+  EXPECT_EQ(ms.count(7), 2);
+  EXPECT_EQ((*ms.rbegin()).first, 49);
+
+  ms.insert(ms.find(7), 7);
+  EXPECT_EQ(ms.count(7), 3);
+  ms.emplace_hint(ms.begin(), -3);
+  EXPECT_EQ((*ms.begin()).first, -3);
+  EXPECT_EQ(ms.size(), 102);
+}
+
+TEST(Multiset, Test_17) {
+  my::multiset<int, std::less<int>, true> ms{3, 3, 7};
+  std::vector<int> batch{7, 1, 3, 9, 7, 1};
+  std::vector<my::multiset<int, std::less<int>, true>::iterator> res;
+  ms.insert(batch.begin(), batch.end(), std::back_inserter(res));
+
+  EXPECT_EQ(ms.size(), 9);
+  EXPECT_EQ(ms.count(1), 2);
+  EXPECT_EQ(ms.count(3), 3);
+  EXPECT_EQ(ms.count(7), 3);
+  EXPECT_EQ(ms.count(9), 1);
+  EXPECT_EQ(ms.rank(9), 8);
+  EXPECT_EQ(res.size(), 6);
+  EXPECT_EQ((*res[0]).first, 7);
+  EXPECT_EQ(res[4], res[0]);
+  EXPECT_EQ(res[1], ms.begin());
+
+  ms.insert(batch.begin(), batch.begin() + 2);
+  EXPECT_EQ(ms.size(), 11);
+  EXPECT_EQ(ms.count(1), 3);
+}
+
+TEST(Multiset, Test_18) {
+  my::multiset<std::string> ms;
+  ms.insert("b");
+  ms.insert("b");
+  auto it = ms.emplace(3, 'a');
+  EXPECT_EQ((*it).first, "aaa");
+  EXPECT_EQ((*it).second, 1);
+  ms.emplace("b");
+  EXPECT_EQ(ms.size(), 4);
+  EXPECT_EQ(ms.count("b"), 3);
+}
@@ -138,7 +138,8 @@ TEST(Set, Test_9) {
 
   EXPECT_EQ(s1.contains(8), true);
   EXPECT_EQ(s2.contains(2), true);
-  EXPECT_EQ(s1.end() == my::set<int>::iterator(nullptr), true);
+  EXPECT_EQ(*--s1.end(), 8);
+  EXPECT_EQ(*--s2.end(), 5);
 }
 
 TEST(Set, Test_10) {
@@ -149,4 +150,281 @@ TEST(Set, Test_10) {
   EXPECT_EQ(it[0].second, false);
   EXPECT_EQ(it[1].second, false);
   EXPECT_EQ(*(it[2].first), 5);
-}
\ No newline at end of file
+}
+TEST(Set, Test_11) {
+  my::set<int> s{1, 2, 3};
+  const int *freed = &*s.find(3);
+  s.erase(s.find(3));
+  auto res = s.insert(7);
+  EXPECT_EQ(&*res.first, freed);
+
+  my::set<std::string> strings;
+  for (int i = 0; i < 5000; i++) strings.insert(std::to_string(i));
+  EXPECT_EQ(strings.size(), 5000);
+  my::set<std::string> copy(strings);
+  strings.clear();
+  EXPECT_EQ(strings.size(), 0);
+  EXPECT_EQ(strings.begin(), strings.end());
+  strings.insert("again");
+  EXPECT_EQ(*strings.begin(), "again");
+  EXPECT_EQ(copy.size(), 5000);
+  EXPECT_TRUE(copy.contains("4999"));
+}
+
+TEST(Set, Test_12) {
+  my::set<int> s{5, 1, 4, 2, 3};
+  int expected = 5;
+  for (auto it = s.rbegin(); it != s.rend(); ++it) EXPECT_EQ(*it, expected--);
+  EXPECT_EQ(expected, 0);
+
+  s.erase(s.begin());
+  s.erase(--s.end());
+  EXPECT_EQ(*s.begin(), 2);
+  EXPECT_EQ(*s.rbegin(), 4);
+  s.insert(0);
+  s.insert(9);
+  EXPECT_EQ(*s.begin(), 0);
+  EXPECT_EQ(*s.rbegin(), 9);
+
+  my::set<int> empty;
+  EXPECT_EQ(empty.begin(), empty.end());
+  EXPECT_EQ(empty.rbegin(), empty.rend());
+  EXPECT_THROW(*empty.end(), std::runtime_error);
+}
+
+TEST(Set, Test_13) {
+  my::set<int, std::greater<int>> s{3, 1, 4, 1, 5, 9, 2, 6};
+  EXPECT_EQ(s.size(), 7);
+  EXPECT_EQ(*s.begin(), 9);
+  EXPECT_EQ(*s.rbegin(), 1);
+  EXPECT_TRUE(s.contains(4));
+  EXPECT_FALSE(s.contains(7));
+  EXPECT_FALSE(s.insert(5).second);
+
+  my::set<std::string, std::less<>> names{"beta", "alpha", "gamma"};
+  std::string_view key = "gamma";
+  EXPECT_EQ(*names.find(key), "gamma");
+  EXPECT_TRUE(names.contains(std::string_view("alpha")));
+  EXPECT_EQ(names.find(std::string_view("delta")), names.end());
+}
+
+TEST(Set, Test_14) {
+  my::Vector<int> sorted;
+  for (int i = 0; i < 1000; i++) sorted.push_back(i * 3);
+  auto s = my::set<int>::from_sorted(sorted.begin(), sorted.end());
+  EXPECT_EQ(s.size(), 1000);
+  EXPECT_EQ(*s.begin(), 0);
+  EXPECT_EQ(*s.rbegin(), 2997);
+  EXPECT_TRUE(s.contains(1500));
+  EXPECT_FALSE(s.contains(1501));
+  s.insert(1501);
+  EXPECT_EQ(*++s.find(1500), 1501);
+
+  int unsorted[] = {5, 3, 5, 1, 4, 1};
+  s.assign_sorted(unsorted, unsorted + 6);
+  EXPECT_EQ(s.size(), 4);
+  int expected[] = {1, 3, 4, 5};
+  int i = 0;
+  for (int x : s) EXPECT_EQ(x, expected[i++]);
+}
+
+TEST(Set, Test_15) {
+  my::set<int> evens, thirds;
+  for (int i = 0; i < 40000; i += 2) evens.insert(i);
+  for (int i = 0; i < 40000; i += 3) thirds.insert(i);
+
+  my::set<int> both = my::set_intersection(evens, thirds, 4);
+  EXPECT_EQ(both.size(), 6667);
+  EXPECT_TRUE(both.contains(6));
+  EXPECT_FALSE(both.contains(4));
+
+  my::set<int> only = my::set_difference(evens, thirds);
+  EXPECT_EQ(only.size(), 20000 - 6667);
+  EXPECT_FALSE(only.contains(6));
+  EXPECT_EQ(*only.rbegin(), 39998);
+
+  my::set<int> any = my::set_union(std::move(evens), thirds, 4);
+  EXPECT_EQ(any.size(), 20000 + 13334 - 6667);
+  EXPECT_EQ(evens.size(), 0);
+
+  // merge() leaves the common elements in the source.
+  my::set<int> s1{1, 2, 3};
+  my::set<int> s2{3, 4};
+  s1.merge(s2);
+  EXPECT_EQ(s1.size(), 4);
+  EXPECT_EQ(s2.size(), 1);
+  EXPECT_EQ(*s2.begin(), 3);
+  s2.insert(7);
+  EXPECT_EQ(*s2.rbegin(), 7);
+
+  s1.subtract(s2);
+  EXPECT_EQ(s1.size(), 3);
+  EXPECT_FALSE(s1.contains(3));
+  s1.intersect(s2);
+  EXPECT_TRUE(s1.empty());
+}
+
+TEST(Set, Test_16) {
+  my::set<int, std::less<int>, true> s;
+  for (int i = 0; i < 100; i++) s.insert((i * 37) % 100 * 2);
+  EXPECT_EQ(*s.nth(0), 0);
+  EXPECT_EQ(*s.nth(10), 20);
+  EXPECT_EQ(*s.nth(99), 198);
+  EXPECT_EQ(s.nth(100), s.end());
+  EXPECT_EQ(s.rank(50), 25);
+  EXPECT_EQ(s.rank(51), 26);
+  EXPECT_EQ(s.rank(1000), 100);
+  EXPECT_EQ(s.count_range(10, 20), 5);
+  EXPECT_EQ(s.count_range(20, 10), 0);
+
+  s.erase(s.find(198));
+  EXPECT_EQ(s.rank(1000), 99);
+  EXPECT_EQ(*s.nth(98), 196);
+
+  my::set<int, std::less<int>, true> odd{1, 3, 5};
+  s.merge(odd);
+  EXPECT_EQ(*s.nth(3), 3);
+  EXPECT_EQ(s.count_range(0, 10), 8);
+}
+
+TEST(Set, Test_17) {
+  my::set<int> s;
+  for (int i = 0; i < 1000; i++) s.insert(s.end(), i);
+  EXPECT_EQ(s.size(), 1000);
+  EXPECT_EQ(*s.rbegin(), 999);
+
+  my::set<int> gaps{0, 10, 20};
+  auto it = gaps.insert(gaps.find(10), 5);
+  EXPECT_EQ(*it, 5);
+  EXPECT_EQ(*++it, 10);
+  EXPECT_EQ(*gaps.insert(gaps.find(10), 15), 15);
+  EXPECT_EQ(*gaps.insert(gaps.begin(), 30), 30);
+  EXPECT_EQ(*gaps.insert(gaps.end(), -1), -1);
+  EXPECT_EQ(gaps.insert(gaps.begin(), 20), gaps.find(20));
+  EXPECT_EQ(gaps.size(), 7);
+  int expected[] = {-1, 0, 5, 10, 15, 20, 30};
+  int i = 0;
+  for (int x : gaps) EXPECT_EQ(x, expected[i++]);
+
+  my::set<std::string> names;
+  names.emplace_hint(names.end(), 3, 'a');
+  names.emplace_hint(names.end(), "b");
+  EXPECT_EQ(*names.emplace_hint(names.begin(), "aaa"), "aaa");
+  EXPECT_EQ(names.size(), 2);
+}
+
+TEST(Set, Test_18) {
+  my::set<int> s{1, 2, 3, 4, 5};
+  const int *addr = &*s.find(4);
+
+  auto nh = s.extract(s.find(4));
+  EXPECT_FALSE(nh.empty());
+  EXPECT_EQ(nh.value(), 4);
+  EXPECT_EQ(s.size(), 4);
+  EXPECT_FALSE(s.contains(4));
+
+  nh.value() = 40;
+  auto res = s.insert(std::move(nh));
+  EXPECT_TRUE(res.inserted);
+  EXPECT_TRUE(nh.empty());
+  EXPECT_EQ(&*res.position, addr);
+  EXPECT_EQ(*s.rbegin(), 40);
+
+  EXPECT_TRUE(s.extract(7).empty());
+
+  my::set<int> other{1};
+  res = other.insert(s.extract(1));
+  EXPECT_FALSE(res.inserted);
+  EXPECT_EQ(res.node.value(), 1);
+  res = other.insert(s.extract(2));
+  EXPECT_TRUE(res.inserted);
+  EXPECT_EQ(other.size(), 2);
+  EXPECT_EQ(s.size(), 3);
+  EXPECT_EQ(*s.begin(), 3);
+}
+
+TEST(Set, Test_19) {
+  my::set<int> s;
+  for (int i = 0; i < 200; i++) s.insert(i);
+  auto kept = s.find(101);
+  const int *addr = &*kept;
+
+  for (int i = 0; i < 200; i += 2) s.erase(s.find((i * 77) % 200));
+  EXPECT_EQ(s.size(), 100);
+  EXPECT_EQ(&*kept, addr);
+  EXPECT_EQ(*kept, 101);
+  EXPECT_EQ(*++kept, 103);
+  int expected = 1;
+  for (int x : s) {
+    EXPECT_EQ(x, expected);
+    expected += 2;
+  }
+
+  for (int i = 1; i < 200; i += 2) s.erase(s.find(i));
+  EXPECT_TRUE(s.empty());
+  EXPECT_EQ(s.begin(), s.end());
+}
+
+TEST(Set, Test_20) {
+  my::set<int> s;
+  for (int i = 0; i < 100; i += 10) s.insert(i);
+
+  EXPECT_EQ(*s.lower_bound(30), 30);
+  EXPECT_EQ(*s.upper_bound(30), 40);
+  EXPECT_EQ(*s.lower_bound(31), 40);
+  EXPECT_EQ(*s.upper_bound(-5), 0);
+  EXPECT_EQ(s.lower_bound(91), s.end());
+  EXPECT_EQ(s.upper_bound(90), s.end());
+
+  auto hit = s.equal_range(50);
+  EXPECT_EQ(*hit.first, 50);
+  EXPECT_EQ(*hit.second, 60);
+  auto miss = s.equal_range(55);
+  EXPECT_EQ(miss.first, miss.second);
+  EXPECT_EQ(*miss.first, 60);
+}
+
+TEST(Set, Test_21) {
+  my::set<int> s;
+  for (int i = 0; i < 1000; i += 3) s.insert(i);
+
+  std::vector<int> keys;
+  for (int i = 0; i < 700; i++) keys.push_back((i * 37) % 1001 - 1);
+  for (bool sort_batch : {false, true}) {
+    std::vector<my::set<int>::iterator> found(keys.size());
+    auto end = s.find_many(keys.begin(), keys.end(), found.begin(), sort_batch);
+    EXPECT_EQ(end, found.end());
+    for (size_t i = 0; i < keys.size(); i++) {
+      EXPECT_EQ(found[i], s.find(keys[i]));
+    }
+  }
+
+  my::set<int> empty;
+  std::vector<my::set<int>::iterator> none;
+  empty.find_many(keys.begin(), keys.begin() + 3, std::back_inserter(none));
+  EXPECT_EQ(none.size(), 3);
+  EXPECT_EQ(none[2], empty.end());
+}
+
+TEST(Set, Test_22) {
+  my::set<int> s{10, 20, 30};
+  std::vector<int> batch{25, 5, 20, 35, 5, 15};
+  s.insert(batch.begin(), batch.end());
+  EXPECT_EQ(s.size(), 7);
+  int expected[] = {5, 10, 15, 20, 25, 30, 35};
+  int i = 0;
+  for (int x : s) EXPECT_EQ(x, expected[i++]);
+
+  std::vector<std::pair<my::set<int>::iterator, bool>> res;
+  int more[] = {40, 10, 0, 40};
+  s.insert(std::begin(more), std::end(more), std::back_inserter(res));
+  EXPECT_EQ(s.size(), 9);
+  EXPECT_EQ(res.size(), 4);
+  EXPECT_TRUE(res[0].second);
+  EXPECT_FALSE(res[1].second);
+  EXPECT_TRUE(res[2].second);
+  EXPECT_FALSE(res[3].second);
+  EXPECT_EQ(res[3].first, res[0].first);
+  EXPECT_EQ(*res[1].first, 10);
+  EXPECT_EQ(res[2].first, s.begin());
+}
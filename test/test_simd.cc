@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "../headers/my_array.h"
+#include "../headers/my_simd.h"
+#include "../headers/my_vector.h"
+
+using namespace my;
+
+// Every kernel is run at each instruction set level the machine has and
+// checked against the scalar path.
+static const simd::isa levels[] = {simd::isa::scalar, simd::isa::sse42,
+                                   simd::isa::avx2};
+
+TEST(SimdTest, Find_Count) {
+  Vector<std::int32_t> v;
+  for (int i = 0; i < 1000; i++) v.push_back(i % 37);
+  Vector<char> bytes;
+  for (int i = 0; i < 333; i++) bytes.push_back('a' + i % 20);
+  Vector<double> d = {1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5};
+
+  for (simd::isa level : levels) {
+    simd::limit_isa(level);
+    EXPECT_EQ(simd::find(v, 36), v.data() + 36);
+    EXPECT_EQ(simd::find(v, 99), v.data() + v.size());
+    EXPECT_EQ(simd::count(v, 5), 27);
+    EXPECT_EQ(simd::count(bytes, 't'), 16);
+    EXPECT_EQ(simd::find(d, 7.5), d.data() + 6);
+    EXPECT_EQ(simd::count(d, 0.0), 0);
+    EXPECT_EQ(simd::find_byte(bytes, 'e'), bytes.data() + 4);
+    EXPECT_EQ(simd::find_byte(bytes, 'z'), nullptr);
+  }
+  simd::limit_isa(simd::isa::avx2);
+}
+
+TEST(SimdTest, Reductions) {
+  Vector<std::int32_t> v;
+  for (int i = 0; i < 1001; i++) v.push_back((i * 7919) % 1000 - 500);
+  Vector<float> f;
+  for (int i = 0; i < 19; i++) f.push_back(i * 0.5f);
+  array<double, 5> d = {3.0, -1.0, 8.0, 2.0, 0.5};
+
+  for (simd::isa level : levels) {
+    simd::limit_isa(level);
+    EXPECT_EQ(simd::min(v), -500);
+    EXPECT_EQ(simd::max(v), 499);
+    EXPECT_EQ(simd::sum(v), -1000);
+    EXPECT_EQ(simd::sum(v.data(), v.data() + v.size(), 1000), 0);
+    EXPECT_FLOAT_EQ(simd::sum(f), 85.5f);
+    EXPECT_FLOAT_EQ(simd::max(f), 9.0f);
+    EXPECT_DOUBLE_EQ(simd::min(d), -1.0);
+    EXPECT_DOUBLE_EQ(simd::sum(d), 12.5);
+  }
+  simd::limit_isa(simd::isa::avx2);
+
+  Vector<int> empty;
+  EXPECT_THROW(simd::min(empty), std::out_of_range);
+  EXPECT_EQ(simd::sum(empty), 0);
+}
+
+TEST(SimdTest, Fill_Equal) {
+  for (simd::isa level : levels) {
+    simd::limit_isa(level);
+    Vector<std::int16_t> a(67);
+    Vector<std::int16_t> b(67);
+    simd::fill(a, 3);
+    simd::fill(b, 3);
+    EXPECT_EQ(a[66], 3);
+    EXPECT_TRUE(simd::equal(a, b));
+    b[65] = 4;
+    EXPECT_FALSE(simd::equal(a, b));
+
+    Vector<unsigned char> c(9);
+    simd::fill(c, 0xab);
+    EXPECT_EQ(c[8], 0xab);
+
+    Vector<double> x(11);
+    Vector<double> y(11);
+    simd::fill(x, 0.0);
+    simd::fill(y, -0.0);
+    EXPECT_TRUE(simd::equal(x, y));
+    y[10] = 1.0;
+    EXPECT_FALSE(simd::equal(x, y));
+  }
+  simd::limit_isa(simd::isa::avx2);
+}
+
+// Equality of a class goes through its operator==, not its bytes.
+struct TaggedValue {
+  int value;
+  int tag;
+
+  bool operator==(const TaggedValue &other) const {
+    return value == other.value;
+  }
+};
+
+TEST(SimdTest, Equal_User_Type) {
+  TaggedValue a[] = {{1, 0}, {2, 0}, {3, 0}};
+  TaggedValue b[] = {{1, 7}, {2, 8}, {3, 9}};
+  EXPECT_TRUE(simd::equal(a, a + 3, b));
+  b[2].value = 4;
+  EXPECT_FALSE(simd::equal(a, a + 3, b));
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include "../headers/my_small_vector.h"
+
+using namespace my;
+
+TEST(SmallVectorTest, Inline_Storage) {
+  small_vector<int, 8> v;
+  EXPECT_EQ(v.size(), 0);
+  EXPECT_EQ(v.capacity(), 8);
+  EXPECT_TRUE(v.is_inline());
+
+  for (int i = 0; i < 8; i++) v.push_back(i);
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(v.back(), 7);
+
+  v.push_back(8);
+  EXPECT_FALSE(v.is_inline());
+  EXPECT_EQ(v.capacity(), 16);
+  EXPECT_EQ(v.size(), 9);
+  for (int i = 0; i < 9; i++) EXPECT_EQ(v[i], i);
+}
+
+TEST(SmallVectorTest, Shrink_Back_Inline) {
+  small_vector<std::string, 4> v = {"a", "b", "c", "d", "e"};
+  EXPECT_FALSE(v.is_inline());
+  v.pop_back();
+  v.pop_back();
+  v.shrink_to_fit();
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(v.size(), 3);
+  EXPECT_EQ(v.at(2), "c");
+  EXPECT_THROW(v.at(3), std::out_of_range);
+}
+
+TEST(SmallVectorTest, Copy_Move_Swap) {
+  small_vector<std::string, 2> a = {"x"};
+  small_vector<std::string, 2> b = {"1", "2", "3"};
+  small_vector<std::string, 2> c(b);
+  EXPECT_EQ(c.size(), 3);
+  EXPECT_EQ(c[2], "3");
+
+  small_vector<std::string, 2> d(std::move(a));
+  EXPECT_TRUE(d.is_inline());
+  EXPECT_EQ(d.front(), "x");
+  EXPECT_TRUE(a.empty());
+
+  d.swap(b);
+  EXPECT_EQ(d.size(), 3);
+  EXPECT_EQ(b.size(), 1);
+  EXPECT_EQ(b.front(), "x");
+
+  b = std::move(c);
+  EXPECT_EQ(b.size(), 3);
+  EXPECT_TRUE(c.empty());
+  EXPECT_TRUE(c.is_inline());
+}
+
+TEST(SmallVectorTest, Insert_Erase) {
+  small_vector<int, 4> v = {1, 2, 3};
+  v.insert(v.begin(), 0);
+  v.insert_many(v.begin() + 2, 10, 11);
+  v.insert_many_back(4, 5);
+  int expected[] = {0, 1, 10, 11, 2, 3, 4, 5};
+  EXPECT_EQ(v.size(), 8);
+  for (size_t i = 0; i < v.size(); i++) EXPECT_EQ(v[i], expected[i]);
+
+  v.erase(v.begin() + 2, v.begin() + 4);
+  v.erase(v.begin());
+  EXPECT_EQ(v.size(), 5);
+  EXPECT_EQ(v.front(), 1);
+  EXPECT_EQ(v.remove_if([](int x) { return x % 2 == 0; }), 2);
+  EXPECT_EQ(v.size(), 3);
+  EXPECT_EQ(v.back(), 5);
+
+  v.clear();
+  EXPECT_TRUE(v.empty());
+  v.reserve(100);
+  EXPECT_EQ(v.capacity(), 100);
+}
+
+struct ThrowOnNegative {
+  std::string s;
+  ThrowOnNegative(int x) {
+    if (x < 0) throw std::invalid_argument("negative");
+    s.assign(x, 'x');
+  }
+};
+
+TEST(SmallVectorTest, Insert_Many_Throws) {
+  small_vector<ThrowOnNegative, 4> v;
+  v.insert_many_back(20);
+  EXPECT_THROW(v.insert_many_back(30, -1, 40), std::invalid_argument);
+  EXPECT_EQ(v.size(), 2);
+  EXPECT_EQ(v.back().s.size(), 30);
+
+  EXPECT_THROW(v.insert_many(v.begin(), 50, -1), std::invalid_argument);
+  EXPECT_EQ(v.size(), 2);
+  EXPECT_EQ(v.front().s.size(), 20);
+  EXPECT_EQ(v.back().s.size(), 30);
+}
+
+TEST(SmallVectorTest, Insert_Many_Aliased) {
+  small_vector<std::string, 2> v = {std::string(40, 'a'),
+                                    std::string(40, 'b')};
+  EXPECT_TRUE(v.is_inline());
+  v.insert_many_back(v[0], v[1]);
+  EXPECT_FALSE(v.is_inline());
+  EXPECT_EQ(v.size(), 4);
+  EXPECT_EQ(v[2], std::string(40, 'a'));
+  EXPECT_EQ(v[3], std::string(40, 'b'));
+}
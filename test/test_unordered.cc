@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../headers/my_unordered_map.h"
+#include "../headers/my_unordered_set.h"
+
+TEST(UnorderedSet, Test_1) {
+  my::unordered_set<int> s = {4, 8, 15, 16, 23, 42, 8};
+  EXPECT_EQ(6, s.size());
+  EXPECT_EQ(true, s.contains(15));
+  EXPECT_EQ(false, s.contains(7));
+
+  EXPECT_EQ(false, s.insert(42).second);
+  EXPECT_EQ(true, s.insert(7).second);
+  s.erase(s.find(4));
+  EXPECT_EQ(false, s.contains(4));
+  EXPECT_EQ(6, s.size());
+
+  int sum = 0;
+  for (int v : s) sum += v;
+  EXPECT_EQ(111, sum);
+}
+
+// Enough inserts and erases to rehash several times and to shift long
+// runs back over erased slots.
+TEST(UnorderedSet, Test_2) {
+  my::unordered_set<int> s;
+  for (int i = 0; i < 100000; i++) s.insert(i);
+  EXPECT_EQ(100000, s.size());
+  EXPECT_LE(s.load_factor(), 0.875f);
+
+  for (int i = 0; i < 100000; i += 2) s.erase(s.find(i));
+  EXPECT_EQ(50000, s.size());
+  for (int i = 0; i < 100000; i++) EXPECT_EQ(i % 2 == 1, s.contains(i));
+
+  my::unordered_set<int> other = {1, 2, 4};
+  s.merge(other);
+  EXPECT_EQ(50002, s.size());
+  EXPECT_EQ(1, other.size());
+  EXPECT_EQ(true, other.contains(1));
+
+  s.clear();
+  EXPECT_EQ(true, s.empty());
+  EXPECT_EQ(true, s.begin() == s.end());
+}
+
+TEST(UnorderedMap, Test_1) {
+  my::unordered_map<std::string, int> m = {{"a", 1}, {"b", 2}, {"a", 3}};
+  EXPECT_EQ(2, m.size());
+  EXPECT_EQ(3, m.at("a"));
+  EXPECT_THROW(m.at("c"), std::runtime_error);
+
+  EXPECT_EQ(true, m.insert("c", 4).second);
+  EXPECT_EQ(false, m.insert({"c", 5}).second);
+  EXPECT_EQ(false, m.insert_or_assign("c", 6).second);
+  EXPECT_EQ(6, m["c"]);
+
+  m.find("b")->second = 20;
+  EXPECT_EQ(20, m.at("b"));
+  m.erase(m.find("a"));
+  EXPECT_EQ(false, m.contains("a"));
+
+  auto res = m.insert_many(std::pair<std::string, int>{"d", 7},
+                           std::pair<std::string, int>{"b", 0});
+  EXPECT_EQ(true, res[0].second);
+  EXPECT_EQ(false, res[1].second);
+  EXPECT_EQ(7, res[0].first->second);
+  EXPECT_EQ(20, res[1].first->second);
+}
+
+TEST(UnorderedMap, Test_2) {
+  my::unordered_map<int, std::string> m;
+  m.reserve(1000);
+  size_t capacity = m.capacity();
+  for (int i = 0; i < 1000; i++) m.insert(i, std::to_string(i));
+  EXPECT_EQ(capacity, m.capacity());
+
+  my::unordered_map<int, std::string> copy(m);
+  for (int i = 0; i < 1000; i += 3) m.erase(m.find(i));
+  EXPECT_EQ(666, m.size());
+  EXPECT_EQ(1000, copy.size());
+  EXPECT_EQ("999", copy.at(999));
+  EXPECT_EQ(false, m.contains(999));
+  EXPECT_EQ("998", m.at(998));
+}
+
+TEST(UnorderedMap, Test_3) {
+  my::unordered_map<int, int> m;
+  for (int i = 0; i < 10000; i++) m[i % 1000] += 1;
+  EXPECT_EQ(1000, m.size());
+  for (int i = 0; i < 1000; i++) EXPECT_EQ(10, m.at(i));
+
+  EXPECT_EQ(false, m.try_emplace(5, 0).second);
+  EXPECT_EQ(true, m.try_emplace(1000, 3).second);
+  EXPECT_EQ(false, m.insert_or_assign(1000, 4).second);
+  EXPECT_EQ(4, m.at(1000));
+  EXPECT_EQ(false, m.emplace(1000, 5).second);
+  EXPECT_EQ(true, m.emplace(1001, 5).second);
+  EXPECT_EQ(1002, m.size());
+}
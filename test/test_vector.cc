@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <memory_resource>
+
 #include "../headers/my_vector.h"
 
 using namespace my;
@@ -7,7 +9,8 @@ using namespace my;
 TEST(MYVectorTest, ConstructorTest) {
   Vector<int> v;
   EXPECT_EQ(v.size(), 0);
-  EXPECT_EQ(v.capacity(), 15);
+  EXPECT_EQ(v.capacity(), 0);
+  EXPECT_EQ(v.data(), nullptr);
 }
 
 TEST(MYVectorTest, ConstructorTest1) {
@@ -96,7 +99,7 @@ TEST(MYVectorTest, Method_Reserve) {
   Vector<int> v = {1, 2, 3, 4, 5, 6, 7};
   Vector<int> v2(v);
   v2.reserve(45);
-  EXPECT_EQ(v.capacity(), 15);
+  EXPECT_EQ(v.capacity(), 7);
   EXPECT_EQ(v2.capacity(), 45);
 }
 
@@ -105,7 +108,7 @@ TEST(MYVectorTest, Method_Shrink_TO_FIT) {
   Vector<int> v2(v);
   v2.reserve(45);
   v2.shrink_to_fit();
-  EXPECT_EQ(v.capacity(), 15);
+  EXPECT_EQ(v.capacity(), 7);
   EXPECT_EQ(v2.capacity(), 7);
 }
 
@@ -113,7 +116,7 @@ TEST(MYVectorTest, Method_Clear) {
   Vector<int> v = {1, 2, 3, 4, 5, 6, 7};
   v.clear();
   EXPECT_EQ(v.empty(), true);
-  EXPECT_EQ(v.capacity(), 15);
+  EXPECT_EQ(v.capacity(), 7);
 }
 
 TEST(MYVectorTest, Method_Insert) {
@@ -144,6 +147,19 @@ TEST(MYVectorTest, Method_Insert_Many_back) {
   EXPECT_EQ(v.size(), 10);
 }
 
+TEST(MYVectorTest, Method_Insert_Many_Aliased) {
+  Vector<std::string> v = {std::string(40, 'a'), std::string(40, 'b')};
+  v.shrink_to_fit();
+  v.insert_many_back(v[0], v[1]);
+  EXPECT_EQ(v.size(), 4);
+  EXPECT_EQ(v[2], std::string(40, 'a'));
+  EXPECT_EQ(v[3], std::string(40, 'b'));
+
+  v.shrink_to_fit();
+  v.insert_many(v.begin(), v[3]);
+  EXPECT_EQ(v[0], std::string(40, 'b'));
+}
+
 TEST(MYVectorTest, Method_Erase_) {
   Vector<int> v = {1, 2, 3, 4, 5, 6, 7};
   v.erase(v.begin() + 1);
@@ -184,3 +200,299 @@ TEST(MYVectorTest, Other) {
 
   EXPECT_THROW(v.at(1000), std::out_of_range);
 }
+
+namespace {
+struct Tracked {
+  static int constructed;
+  static int destroyed;
+  int value;
+  Tracked() : value(0) { ++constructed; }
+  Tracked(int v) : value(v) { ++constructed; }
+  Tracked(const Tracked &other) : value(other.value) { ++constructed; }
+  Tracked(Tracked &&other) noexcept : value(other.value) { ++constructed; }
+  Tracked &operator=(const Tracked &other) = default;
+  Tracked &operator=(Tracked &&other) noexcept = default;
+  ~Tracked() { ++destroyed; }
+};
+int Tracked::constructed = 0;
+int Tracked::destroyed = 0;
+}  // namespace
+
+TEST(MYVectorTest, Raw_Storage) {
+  Tracked::constructed = Tracked::destroyed = 0;
+  {
+    Vector<Tracked> v;
+    EXPECT_EQ(Tracked::constructed, 0);
+    for (int i = 0; i < 40; i++) v.emplace_back(i);
+    EXPECT_EQ(v.size(), 40);
+    EXPECT_EQ(v[39].value, 39);
+    EXPECT_EQ(Tracked::constructed - Tracked::destroyed, 40);
+  }
+  EXPECT_EQ(Tracked::constructed, Tracked::destroyed);
+}
+
+TEST(MYVectorTest, Clear_Keeps_Buffer) {
+  Tracked::constructed = Tracked::destroyed = 0;
+  Vector<Tracked> v;
+  for (int i = 0; i < 10; i++) v.push_back(Tracked(i));
+  Tracked *buffer = v.data();
+  size_t cap = v.capacity();
+  v.clear();
+  EXPECT_EQ(v.data(), buffer);
+  EXPECT_EQ(v.capacity(), cap);
+  EXPECT_EQ(Tracked::constructed, Tracked::destroyed);
+}
+
+TEST(MYVectorTest, Insert_Erase_Objects) {
+  Vector<std::string> v = {"a", "b", "c"};
+  v.insert(v.begin(), v[2]);
+  v.insert_many(v.begin() + 2, "x", "y");
+  EXPECT_EQ(v.size(), 6);
+  EXPECT_EQ(v[0], "c");
+  EXPECT_EQ(v[2], "x");
+  EXPECT_EQ(v[3], "y");
+  EXPECT_EQ(v[5], "c");
+  v.erase(v.begin());
+  v.pop_back();
+  EXPECT_EQ(v.size(), 4);
+  EXPECT_EQ(v.front(), "a");
+  EXPECT_EQ(v.back(), "b");
+}
+
+namespace {
+struct Handle {
+  int *ptr;
+  explicit Handle(int v) : ptr(new int(v)) {}
+  Handle(const Handle &other) : ptr(new int(*other.ptr)) {}
+  Handle &operator=(const Handle &other) {
+    *ptr = *other.ptr;
+    return *this;
+  }
+  ~Handle() { delete ptr; }
+};
+}  // namespace
+
+template <>
+struct my::is_trivially_relocatable<Handle> : std::true_type {};
+
+TEST(MYVectorTest, Trivially_Relocatable) {
+  EXPECT_TRUE((my::is_trivially_relocatable_v<std::pair<int, double>>));
+  EXPECT_FALSE(my::is_trivially_relocatable_v<std::string>);
+
+  Vector<Handle> v;
+  for (int i = 0; i < 100; i++) v.push_back(Handle(i));
+  v.insert(v.begin(), v[50]);
+  v.insert_many(v.begin() + 1, Handle(-1), Handle(-2));
+  v.erase(v.begin() + 3);
+  v.shrink_to_fit();
+
+  EXPECT_EQ(v.size(), 102);
+  EXPECT_EQ(*v[0].ptr, 50);
+  EXPECT_EQ(*v[1].ptr, -1);
+  EXPECT_EQ(*v[2].ptr, -2);
+  EXPECT_EQ(*v[3].ptr, 1);
+  EXPECT_EQ(*v.back().ptr, 99);
+}
+
+TEST(MYVectorTest, Realloc_Growth) {
+  Vector<std::pair<int, int>> v;
+  for (int i = 0; i < 1000; i++) v.push_back({i, -i});
+  v.insert_many(v.begin(), std::pair(7, 7), std::pair(8, 8));
+  v.erase(v.begin() + 2);
+  EXPECT_EQ(v.size(), 1001);
+  EXPECT_EQ(v[0].first, 7);
+  EXPECT_EQ(v[1].first, 8);
+  EXPECT_EQ(v[2].first, 1);
+  EXPECT_EQ(v.back().second, -999);
+}
+
+TEST(MYVectorTest, Range_Erase) {
+  Vector<int> v = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  auto it = v.erase(v.begin() + 2, v.begin() + 5);
+  EXPECT_EQ(*it, 5);
+  EXPECT_EQ(v.size(), 7);
+  EXPECT_EQ(v[1], 1);
+  EXPECT_EQ(v[2], 5);
+  EXPECT_EQ(v.back(), 9);
+
+  Vector<std::string> s = {"a", "b", "c", "d"};
+  s.erase(s.begin(), s.begin() + 3);
+  EXPECT_EQ(s.size(), 1);
+  EXPECT_EQ(s.front(), "d");
+}
+
+TEST(MYVectorTest, Range_Insert) {
+  Vector<int> v = {1, 2, 3};
+  int src[] = {7, 8, 9};
+  v.insert(v.begin() + 1, src, src + 3);
+  v.insert(v.begin(), size_t(2), 0);
+  int expected[] = {0, 0, 1, 7, 8, 9, 2, 3};
+  EXPECT_EQ(v.size(), 8);
+  for (size_t i = 0; i < v.size(); i++) EXPECT_EQ(v[i], expected[i]);
+
+  Vector<std::string> s = {"a", "d"};
+  Vector<std::string> mid = {"b", "c"};
+  s.insert(s.begin() + 1, mid.begin(), mid.end());
+  s.insert(s.end(), 2, s[0]);
+  EXPECT_EQ(s.size(), 6);
+  EXPECT_EQ(s[1], "b");
+  EXPECT_EQ(s[3], "d");
+  EXPECT_EQ(s[5], "a");
+}
+
+TEST(MYVectorTest, Erase_If) {
+  Vector<int> v;
+  for (int i = 0; i < 100; i++) v.push_back(i);
+  EXPECT_EQ(erase_if(v, [](int x) { return x % 3 == 0; }), 34);
+  EXPECT_EQ(v.size(), 66);
+  EXPECT_EQ(v[0], 1);
+  EXPECT_EQ(v[1], 2);
+  EXPECT_EQ(v[2], 4);
+  EXPECT_EQ(v.remove_if([](int x) { return x > 50; }), 32);
+  EXPECT_EQ(v.back(), 50);
+}
+
+namespace {
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::false_type;
+  using is_always_equal = std::false_type;
+
+  int *allocations;
+  size_t limit;
+
+  CountingAllocator(int *allocations, size_t limit = 1 << 20)
+      : allocations(allocations), limit(limit) {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &other)
+      : allocations(other.allocations), limit(other.limit) {}
+
+  T *allocate(size_t n) {
+    if (n > limit) throw std::bad_alloc();
+    ++*allocations;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T *ptr, size_t n) {
+    --*allocations;
+    std::allocator<T>().deallocate(ptr, n);
+  }
+  bool operator==(const CountingAllocator &other) const {
+    return allocations == other.allocations;
+  }
+  bool operator!=(const CountingAllocator &other) const {
+    return !(*this == other);
+  }
+};
+}  // namespace
+
+TEST(MYVectorTest, Custom_Allocator) {
+  int live = 0;
+  {
+    CountingAllocator<std::string> alloc(&live);
+    Vector<std::string, CountingAllocator<std::string>> v({"a", "b"}, alloc);
+    EXPECT_EQ(live, 1);
+    for (int i = 0; i < 100; i++) v.push_back(std::to_string(i));
+    EXPECT_EQ(live, 1);
+    EXPECT_EQ(v.get_allocator().allocations, &live);
+
+    Vector<std::string, CountingAllocator<std::string>> copy(v);
+    EXPECT_EQ(live, 2);
+    EXPECT_EQ(copy.back(), "99");
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(MYVectorTest, Move_Between_Allocators) {
+  int first = 0, second = 0;
+  using Alloc = CountingAllocator<int>;
+  Vector<int, Alloc> a({1, 2, 3}, Alloc(&first));
+  Vector<int, Alloc> b{Alloc(&second)};
+  b = std::move(a);
+  EXPECT_EQ(b.size(), 3);
+  EXPECT_EQ(b[2], 3);
+  EXPECT_EQ(b.get_allocator().allocations, &second);
+  EXPECT_TRUE(a.empty());
+}
+
+TEST(MYVectorTest, Allocation_Failure) {
+  int live = 0;
+  using Alloc = CountingAllocator<int>;
+  Vector<int, Alloc> v{Alloc(&live, 64)};
+  v.push_back(1);
+  EXPECT_THROW(v.reserve(1000), std::bad_alloc);
+  EXPECT_EQ(v.size(), 1);
+  EXPECT_EQ(v.front(), 1);
+  EXPECT_THROW(v.reserve(v.max_size() + 1), std::length_error);
+}
+
+TEST(MYVectorTest, Memory_Resource) {
+  char arena[4096];
+  std::pmr::monotonic_buffer_resource pool(arena, sizeof(arena),
+                                           std::pmr::null_memory_resource());
+  Vector<int, std::pmr::polymorphic_allocator<int>> v(&pool);
+  for (int i = 0; i < 100; i++) v.push_back(i);
+  EXPECT_EQ(v.size(), 100);
+  EXPECT_EQ(v.back(), 99);
+  EXPECT_THROW(
+      for (int i = 0; i < 10000; i++) v.push_back(i), std::bad_alloc);
+}
+
+TEST(MYVectorTest, Growth_Policies) {
+  Vector<int> v2x;
+  for (int i = 0; i < 9; i++) v2x.push_back(i);
+  EXPECT_EQ(v2x.capacity(), 16);
+
+  Vector<int, std::allocator<int>, growth_1_5x> v15;
+  for (int i = 0; i < 10; i++) v15.push_back(i);
+  EXPECT_EQ(v15.capacity(), 13);
+
+  Vector<int, std::allocator<int>, growth_fixed_step<10>> step;
+  for (int i = 0; i < 25; i++) step.push_back(i);
+  EXPECT_EQ(step.capacity(), 30);
+  step.insert(step.end(), size_t(12), 0);
+  EXPECT_EQ(step.capacity(), 40);
+
+  Vector<int, std::allocator<int>, growth_page_rounded<>> paged;
+  for (int i = 0; i < 2000; i++) paged.push_back(i);
+  EXPECT_EQ(paged.capacity() * sizeof(int) % 4096, 0);
+  EXPECT_EQ(paged.back(), 1999);
+}
+
+namespace {
+template <typename T>
+struct BoundedAllocator : std::allocator<T> {
+  template <typename U>
+  struct rebind {
+    using other = BoundedAllocator<U>;
+  };
+
+  BoundedAllocator() = default;
+  template <typename U>
+  BoundedAllocator(const BoundedAllocator<U> &) {}
+
+  size_t max_size() const { return 100; }
+};
+}  // namespace
+
+TEST(MYVectorTest, Growth_Clamped_To_Max_Size) {
+  Vector<int, BoundedAllocator<int>> v;
+  for (int i = 0; i < 64; i++) v.push_back(i);
+  EXPECT_EQ(v.capacity(), 64);
+  v.push_back(64);
+  EXPECT_EQ(v.capacity(), 100);
+  while (v.size() < 100) v.push_back(0);
+  EXPECT_THROW(v.push_back(0), std::length_error);
+  EXPECT_EQ(v.size(), 100);
+}
+
+#if MY_CONTAINERS_CHECKED
+TEST(MYVectorTest, Checked_Access) {
+  Vector<int> v = {1, 2, 3};
+  EXPECT_EQ(v[2], 3);
+  EXPECT_DEATH(v[3], "Vector index out of range");
+  v.clear();
+  EXPECT_DEATH(v.front(), "front\\(\\) on an empty Vector");
+  EXPECT_THROW(v.at(0), std::out_of_range);
+}
+#endif